@@ -0,0 +1,305 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  bench_harness.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "bench_harness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "log_tokenizer.h"
+#include "skip_list_stats.h"
+
+//==============================================================================
+// Allocation counting
+//==============================================================================
+
+static std::atomic<std::uint64_t> allocCount(0);
+static std::atomic<std::uint64_t> allocBytes(0);
+
+//------------------------------------------------------------------------------
+
+/// Takes a counted block from malloc(); the only place the operators
+/// allocate.
+static void* allocateCounted(std::size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* ptr = std::malloc(size > 0 ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+/// Gives a block of allocateCounted() back to free(); the only place the
+/// operators deallocate.
+static void releaseCounted(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+//------------------------------------------------------------------------------
+
+void* operator new(std::size_t size)
+{
+    return allocateCounted(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocateCounted(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    releaseCounted(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    releaseCounted(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    releaseCounted(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    releaseCounted(ptr);
+}
+
+//==============================================================================
+// class BenchmarkRunner
+//==============================================================================
+
+BenchmarkRunner::BenchmarkRunner(int repetitions, const std::string& filter)
+    : _repetitions(std::max(repetitions, 1))
+    , _filter(filter)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool BenchmarkRunner::enablePerfCounters()
+{
+    _perf.reset(new PerfCounters());
+    if (_perf->isAnyAvailable())
+        return true;
+
+    _perf.reset();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+void BenchmarkRunner::add(const std::string& name, std::size_t ops,
+                          const Action& setup, const Action& run)
+{
+    if (name.find(_filter) == std::string::npos)
+        return;
+
+    Case benchCase;
+    benchCase.name = name;
+    benchCase.ops = ops;
+    benchCase.setup = setup;
+    benchCase.run = run;
+    _cases.push_back(benchCase);
+}
+
+//------------------------------------------------------------------------------
+
+void BenchmarkRunner::runAll(std::ostream& out)
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-44s %12s %12s %14s %12s\n",
+                  "benchmark", "median ms", "p99 ms", "ops/sec", "allocs/run");
+    out << line;
+
+    for (std::size_t i = 0; i < _cases.size(); ++i)
+    {
+        Result result = runCase(_cases[i]);
+        _results.push_back(result);
+
+        std::snprintf(line, sizeof(line), "%-44s %12.3f %12.3f %14.0f %12.0f",
+                      result.name.c_str(), result.medianNs / 1e6, result.p99Ns / 1e6,
+                      result.opsPerSec, result.allocsPerRun);
+        out << line;
+
+        // hops of single levels only go to JSON
+        for (std::size_t j = 0; j < result.counters.size(); ++j)
+            if (result.counters[j].first.compare(0, 10, "hops_level") != 0)
+            {
+                std::snprintf(line, sizeof(line), "  %s=%.1f",
+                              result.counters[j].first.c_str(), result.counters[j].second);
+                out << line;
+            }
+
+        out << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+BenchmarkRunner::Result BenchmarkRunner::runCase(const Case& benchCase) const
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<double> times;
+    std::uint64_t allocs = 0;
+    std::uint64_t bytes = 0;
+
+    std::uint64_t events[PerfCounters::NUM_EVENTS] = { 0 };
+    SkipListStats stats;
+    stats.reset();
+
+    for (int rep = 0; rep < _repetitions; ++rep)
+    {
+        if (benchCase.setup)
+            benchCase.setup();
+
+        SkipListStats::local().reset();
+        if (_perf)
+            _perf->start();
+
+        std::uint64_t allocsBefore = getAllocCount();
+        std::uint64_t bytesBefore = getAllocBytes();
+        Clock::time_point start = Clock::now();
+
+        benchCase.run();
+
+        Clock::time_point finish = Clock::now();
+        if (_perf)
+        {
+            _perf->stop();
+            for (int i = 0; i < PerfCounters::NUM_EVENTS; ++i)
+                events[i] += _perf->get(static_cast<PerfCounters::Event>(i));
+        }
+
+        const SkipListStats& runStats = SkipListStats::local();
+        for (int i = 0; i < SkipListStats::NUM_OPERATIONS; ++i)
+            stats.calls[i] += runStats.calls[i];
+        for (int i = 0; i < SkipListStats::NUM_LEVELS; ++i)
+            stats.hops[i] += runStats.hops[i];
+
+        allocs += getAllocCount() - allocsBefore;
+        bytes += getAllocBytes() - bytesBefore;
+        times.push_back(std::chrono::duration<double, std::nano>(finish - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    // nearest-rank percentiles
+    std::size_t n = times.size();
+    Result result;
+    result.name = benchCase.name;
+    result.ops = benchCase.ops;
+    result.repetitions = _repetitions;
+    result.medianNs = n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    result.p99Ns = times[std::min(n - 1, (n * 99 + 99) / 100 - 1)];
+    result.minNs = times[0];
+    result.opsPerSec = result.medianNs > 0 ? benchCase.ops * 1e9 / result.medianNs : 0;
+    result.allocsPerRun = static_cast<double>(allocs) / _repetitions;
+    result.bytesPerRun = static_cast<double>(bytes) / _repetitions;
+
+    double totalOps = static_cast<double>(benchCase.ops) * _repetitions;
+    if (totalOps == 0)
+        return result;
+
+    for (int i = 0; _perf && i < PerfCounters::NUM_EVENTS; ++i)
+    {
+        PerfCounters::Event event = static_cast<PerfCounters::Event>(i);
+        if (_perf->isAvailable(event))
+            result.counters.push_back(std::make_pair(std::string(PerfCounters::getName(event)),
+                                                     events[i] / totalOps));
+    }
+
+    // only the lists that run in this thread are counted
+    if (SkipListStats::isEnabled() && stats.getTotalHops() > 0)
+    {
+        result.counters.push_back(std::make_pair(std::string("hops"),
+                                                 stats.getTotalHops() / totalOps));
+
+        for (int i = 0; i < SkipListStats::NUM_LEVELS; ++i)
+            if (stats.hops[i] > 0)
+                result.counters.push_back(std::make_pair(
+                        "hops_level" + std::to_string(i - 1), stats.hops[i] / totalOps));
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+void BenchmarkRunner::writeJson(std::ostream& out) const
+{
+    static const char* const ISA_NAMES[] = { "scalar", "sse4.2", "avx2" };
+
+    out << "{\n"
+        << "  \"context\": {\n"
+#ifdef __VERSION__
+        << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+#ifdef NDEBUG
+        << "    \"assertions\": false,\n"
+#else
+        << "    \"assertions\": true,\n"
+#endif
+        << "    \"tokenizer\": \"" << ISA_NAMES[LogTokenizer::getIsa()] << "\",\n"
+        << "    \"instrumented\": " << (SkipListStats::isEnabled() ? "true" : "false") << ",\n"
+        << "    \"perf_counters\": " << (_perf ? "true" : "false") << ",\n"
+        << "    \"repetitions\": " << _repetitions << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    char line[512];
+    for (std::size_t i = 0; i < _results.size(); ++i)
+    {
+        const Result& r = _results[i];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"name\": \"%s\", \"ops\": %lu, \"repetitions\": %d, "
+                      "\"median_ns\": %.0f, \"p99_ns\": %.0f, \"min_ns\": %.0f, "
+                      "\"ops_per_sec\": %.1f, \"allocs_per_run\": %.1f, \"bytes_per_run\": %.1f",
+                      i == 0 ? "" : ",", r.name.c_str(), static_cast<unsigned long>(r.ops),
+                      r.repetitions, r.medianNs, r.p99Ns, r.minNs, r.opsPerSec,
+                      r.allocsPerRun, r.bytesPerRun);
+        out << line;
+
+        if (!r.counters.empty())
+        {
+            out << ", \"per_op\": {";
+            for (std::size_t j = 0; j < r.counters.size(); ++j)
+            {
+                std::snprintf(line, sizeof(line), "%s\"%s\": %.3f", j == 0 ? "" : ", ",
+                              r.counters[j].first.c_str(), r.counters[j].second);
+                out << line;
+            }
+            out << "}";
+        }
+
+        out << "}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+//------------------------------------------------------------------------------
+
+std::uint64_t BenchmarkRunner::getAllocCount()
+{
+    return allocCount.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+std::uint64_t BenchmarkRunner::getAllocBytes()
+{
+    return allocBytes.load(std::memory_order_relaxed);
+}
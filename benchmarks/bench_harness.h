@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 BenchmarkRunner.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_BENCH_HARNESS_H_
+#define CYBERPOLICE_BENCH_HARNESS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perf_counters.h"
+
+
+/*! ****************************************************************************
+ *  \brief Runs benchmark cases and collects their statistics.
+ *
+ *  A case is a setup, which is not measured, and a run doing a known number
+ *  of operations. Every repetition calls both, so each run starts from the
+ *  same state. Wall time is taken with std::chrono::steady_clock, heap
+ *  allocations are counted by the replaced global operator new.
+ *
+ *  Optionally, hardware counters (PerfCounters) are read around every run,
+ *  and skip list hops are taken from SkipListStats if the lists are built
+ *  with CYBERPOLICE_INSTRUMENT; both are reported per operation. The
+ *  counters include the threads started after enablePerfCounters() and
+ *  joined within the run; hops are counted in the calling thread only.
+ ******************************************************************************/
+class BenchmarkRunner
+{
+public:
+    /// Code of a case.
+    typedef std::function<void ()> Action;
+
+    /// Statistics of a case.
+    struct Result
+    {
+        std::string name;
+        std::size_t ops;                ///< Operations per run.
+        int repetitions;
+        double medianNs;                ///< Wall time of a run.
+        double p99Ns;
+        double minNs;
+        double opsPerSec;               ///< By the median time.
+        double allocsPerRun;            ///< Heap allocations in a run.
+        double bytesPerRun;             ///< Heap bytes allocated in a run.
+
+        /// Per-operation averages of the counters, e.g. ("cycles", 812.5).
+        std::vector<std::pair<std::string, double> > counters;
+    };
+
+public:
+    /// Runs every case \a repetitions times; only cases with \a filter in
+    /// their names are run.
+    BenchmarkRunner(int repetitions, const std::string& filter);
+
+    /// Turns reading of hardware counters on; returns false if none of
+    /// them is available.
+    bool enablePerfCounters();
+
+    /// Adds a case doing \a ops operations in \a run; \a setup goes before
+    /// every run and may be empty.
+    void add(const std::string& name, std::size_t ops, const Action& setup, const Action& run);
+
+    /// Runs the cases and prints a line per case to \a out.
+    void runAll(std::ostream& out);
+
+    /// Writes the results as JSON.
+    void writeJson(std::ostream& out) const;
+
+    /// Returns the results of the cases run.
+    const std::vector<Result>& getResults() const { return _results; }
+
+    /// Returns the number of heap allocations made so far.
+    static std::uint64_t getAllocCount();
+
+    /// Returns the number of heap bytes allocated so far.
+    static std::uint64_t getAllocBytes();
+
+protected:
+    /// A case to run.
+    struct Case
+    {
+        std::string name;
+        std::size_t ops;
+        Action setup;
+        Action run;
+    };
+
+    /// Runs the \a benchCase and returns its statistics.
+    Result runCase(const Case& benchCase) const;
+
+protected:
+    /// Number of runs of each case.
+    int _repetitions;
+
+    /// Substring of the names of the cases to run.
+    std::string _filter;
+
+    /// Cases to run.
+    std::vector<Case> _cases;
+
+    /// Hardware counters, if they are turned on.
+    std::unique_ptr<PerfCounters> _perf;
+
+    /// Results of the cases run.
+    std::vector<Result> _results;
+}; // class BenchmarkRunner
+
+
+#endif // CYBERPOLICE_BENCH_HARNESS_H_
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  concurrent_bench.cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "suites.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_skip_list.h"
+
+/// List used by the cases.
+typedef ConcurrentSkipList<int, int, 16> List;
+
+/// Keeps the results of the lookups alive.
+static std::atomic<long> benchSink(0);
+
+//------------------------------------------------------------------------------
+
+/// State of a mixed case: the setup starts the threads, the run releases
+/// them at once and waits for them, so only the work itself is timed. The
+/// threads end within the run, so the hardware counters include them.
+struct MixedRun
+{
+    MixedRun() : go(false) {}
+
+    std::unique_ptr<List> list;
+    std::vector<std::thread> threads;
+    std::atomic<bool> go;
+};
+
+//------------------------------------------------------------------------------
+
+/// Does the share \a t of \a ops operations, see addMixedCase().
+static void runMixedThread(MixedRun& state, unsigned t, unsigned numThreads, std::size_t ops,
+                           unsigned insertPercent, int keyRange)
+{
+    std::mt19937 random(t + 2);
+
+    while (!state.go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    long sum = 0;
+    for (std::size_t i = t; i < ops; i += numThreads)
+    {
+        int key = static_cast<int>(random() % keyRange);
+        if (random() % 100 < insertPercent)
+        {
+            state.list->insert(key, key);
+            continue;
+        }
+
+        List::Guard guard;
+        List::Node* found = state.list->findFirst(key);
+        if (found != nullptr)
+            sum += found->value;
+    }
+
+    benchSink += sum;
+}
+
+//------------------------------------------------------------------------------
+
+/// \brief Adds \a ops operations of \a numThreads threads on a list of
+/// \a prefill keys; \a insertPercent of them are inserts, the rest are
+/// lookups.
+///
+/// The operations are split between the threads, so ops/sec of the cases
+/// with different numbers of threads are comparable directly.
+static void addMixedCase(BenchmarkRunner& runner, unsigned numThreads, std::size_t prefill,
+                         std::size_t ops, unsigned insertPercent)
+{
+    std::shared_ptr<MixedRun> state(new MixedRun());
+    const int keyRange = static_cast<int>(prefill * 2);
+
+    runner.add("concurrent_skip_list/mixed:" + std::to_string(insertPercent) + "%"
+               + "/threads:" + std::to_string(numThreads),
+               ops,
+               [state, numThreads, prefill, ops, insertPercent, keyRange]()
+               {
+                   state->list.reset(new List());
+                   std::mt19937 random(1);
+                   for (std::size_t i = 0; i < prefill; ++i)
+                   {
+                       int key = static_cast<int>(random() % keyRange);
+                       state->list->insert(key, key);
+                   }
+
+                   // the threads wait for the run
+                   state->go.store(false);
+                   state->threads.clear();
+                   for (unsigned t = 0; t < numThreads; ++t)
+                       state->threads.push_back(std::thread(runMixedThread, std::ref(*state), t,
+                                                            numThreads, ops, insertPercent,
+                                                            keyRange));
+               },
+               [state]()
+               {
+                   state->go.store(true, std::memory_order_release);
+                   for (std::size_t t = 0; t < state->threads.size(); ++t)
+                       state->threads[t].join();
+               });
+}
+
+//------------------------------------------------------------------------------
+
+void addConcurrentBenchmarks(BenchmarkRunner& runner)
+{
+    const std::size_t PREFILL = 100000;
+    const std::size_t OPS = 200000;
+
+    // up to 16 threads, or one per core on larger machines
+    unsigned maxThreads = std::max(16u, std::thread::hardware_concurrency());
+    for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        addMixedCase(runner, numThreads, PREFILL, OPS, 50);
+        addMixedCase(runner, numThreads, PREFILL, OPS, 10);
+    }
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  journal_bench.cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "suites.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "journal_net_activity.h"
+#include "log_generator.h"
+
+/// Keeps the query output alive.
+static volatile std::size_t benchSink;
+
+/// Journal used by the cases.
+typedef JournalNetActivity<16> Journal;
+
+//------------------------------------------------------------------------------
+
+/// Returns a log of \a lines records of 5000 users on 300 hosts, 20 a
+/// second, with the given fraction of delayed records.
+static std::shared_ptr<std::string> generateLog(std::size_t lines, double disorder = 0)
+{
+    LogGenerator::Options options;
+    options.lines = lines;
+    options.disorder = disorder;
+
+    return std::shared_ptr<std::string>(new std::string(LogGenerator(options).generateText()));
+}
+
+//------------------------------------------------------------------------------
+
+/// Adds parsing of a log of \a lines records.
+static void addParseCase(BenchmarkRunner& runner, std::size_t lines, unsigned numThreads,
+                         double disorder = 0)
+{
+    std::shared_ptr<std::string> log = generateLog(lines, disorder);
+    std::shared_ptr<std::unique_ptr<Journal> > journal(new std::unique_ptr<Journal>());
+
+    std::string name = "journal/parse/" + std::to_string(lines);
+    if (disorder > 0)
+        name += "/disorder:" + std::to_string(static_cast<int>(disorder * 100)) + "%";
+
+    runner.add(name + "/threads:" + std::to_string(numThreads),
+               lines,
+               [journal]() { journal->reset(new Journal()); },
+               [journal, log, numThreads]()
+               {
+                   (*journal)->parseLogFromBuffer(log->data(), log->size(), numThreads);
+               });
+}
+
+//------------------------------------------------------------------------------
+
+void addJournalBenchmarks(BenchmarkRunner& runner)
+{
+    addParseCase(runner, 100000, 1);
+    addParseCase(runner, 1000000, 1);
+    addParseCase(runner, 1000000, 0);
+    addParseCase(runner, 1000000, 1, 0.05);
+    addParseCase(runner, 1000000, 0, 0.05);
+
+    // queries on a log of 1M records, about 14 hours
+    const std::size_t LINES = 1000000;
+    std::shared_ptr<std::unique_ptr<Journal> > journal(new std::unique_ptr<Journal>());
+    std::function<void ()> prepare = [journal]()
+    {
+        if (*journal)
+            return;
+
+        std::shared_ptr<std::string> log = generateLog(LINES);
+        journal->reset(new Journal());
+        (*journal)->parseLogFromBuffer(log->data(), log->size());
+    };
+
+    OutputBuffer::Sink discard = [](const char* /*data*/, std::size_t size) { benchSink = size; };
+
+    // ~20 records of a host an hour; ops are the queries
+    const std::size_t QUERIES = 1000;
+    runner.add("journal/query_host/hour", QUERIES, prepare,
+               [journal, discard, QUERIES]()
+               {
+                   for (std::size_t i = 0; i < QUERIES; ++i)
+                   {
+                       int hour = static_cast<int>(i % 13);
+                       (*journal)->outputSuspiciousActivities(
+                               "host" + std::to_string(i % 300) + ".ru",
+                               TimeStamp(2015, 6, 10, hour, 0, 0),
+                               TimeStamp(2015, 6, 10, hour + 1, 0, 0), discard);
+                   }
+               });
+
+    runner.add("journal/query_user/all", QUERIES, prepare,
+               [journal, discard, QUERIES]()
+               {
+                   for (std::size_t i = 0; i < QUERIES; ++i)
+                       (*journal)->outputUserActivities(
+                               "user" + std::to_string(i % 5000),
+                               TimeStamp(2015, 6, 10), TimeStamp(2015, 6, 11), discard);
+               });
+
+    std::shared_ptr<std::ostringstream> text(new std::ostringstream());
+    runner.add("journal/query_host/endl", 100, prepare,
+               [journal, text]()
+               {
+                   for (int i = 0; i < 100; ++i)
+                   {
+                       text->str("");
+                       (*journal)->outputSuspiciousActivities(
+                               "host" + std::to_string(i) + ".ru",
+                               TimeStamp(2015, 6, 10), TimeStamp(2015, 6, 11), *text);
+                   }
+               });
+}
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  list_bench.cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "suites.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ordered_list.h"
+#include "skip_list.h"
+
+/// Keeps the results of the lookups alive.
+static volatile long benchSink;
+
+//------------------------------------------------------------------------------
+
+/// Returns the keys 0..size-1 in a random, but always the same, order.
+static std::shared_ptr<std::vector<int> > shuffledKeys(std::size_t size)
+{
+    std::shared_ptr<std::vector<int> > keys(new std::vector<int>(size));
+    for (std::size_t i = 0; i < size; ++i)
+        (*keys)[i] = static_cast<int>(i);
+
+    std::mt19937 random(static_cast<unsigned>(size));
+    std::shuffle(keys->begin(), keys->end(), random);
+
+    return keys;
+}
+
+//------------------------------------------------------------------------------
+
+/// Adds insert, find and remove of \a size shuffled keys on a \a List.
+template <class List>
+static void addListCases(BenchmarkRunner& runner, const std::string& name, std::size_t size)
+{
+    typedef std::shared_ptr<std::unique_ptr<List> > ListHolder;
+
+    std::shared_ptr<std::vector<int> > keys = shuffledKeys(size);
+    std::string suffix = "/" + std::to_string(size);
+
+    std::function<void (const ListHolder&)> fill = [keys](const ListHolder& list)
+    {
+        list->reset(new List());
+        for (std::size_t i = 0; i < keys->size(); ++i)
+            (*list)->insert((*keys)[i], (*keys)[i]);
+    };
+
+    ListHolder inserted(new std::unique_ptr<List>());
+    runner.add(name + "/insert" + suffix, size,
+               [inserted]() { inserted->reset(new List()); },
+               [inserted, keys]()
+               {
+                   for (std::size_t i = 0; i < keys->size(); ++i)
+                       (*inserted)->insert((*keys)[i], (*keys)[i]);
+               });
+
+    ListHolder found(new std::unique_ptr<List>());
+    runner.add(name + "/find" + suffix, size,
+               [found, fill]()
+               {
+                   if (!*found)
+                       fill(found);
+               },
+               [found, keys]()
+               {
+                   long sum = 0;
+                   for (std::size_t i = 0; i < keys->size(); ++i)
+                       sum += (*found)->findFirst((*keys)[i])->value;
+                   benchSink = sum;
+               });
+
+    ListHolder removed(new std::unique_ptr<List>());
+    runner.add(name + "/remove" + suffix, size,
+               [removed, fill]() { fill(removed); },
+               [removed, keys]()
+               {
+                   for (std::size_t i = 0; i < keys->size(); ++i)
+                       (*removed)->removeNext((*removed)->findLastLessThan((*keys)[i]));
+               });
+}
+
+//------------------------------------------------------------------------------
+
+/// \brief Adds the lookups of the old demo in main.cpp on a \a List: the
+/// keys 0..199999 are inserted in order and looked up in the same order.
+template <class List>
+static void addDemoFindCase(BenchmarkRunner& runner, const std::string& name)
+{
+    const int SIZE = 200 * 1000;
+
+    std::shared_ptr<std::unique_ptr<List> > list(new std::unique_ptr<List>());
+    runner.add(name + "/find/" + std::to_string(SIZE), SIZE,
+               [list, SIZE]()
+               {
+                   if (*list)
+                       return;
+
+                   list->reset(new List());
+                   for (int i = 0; i < SIZE; ++i)
+                       (*list)->insert(i, i);
+               },
+               [list, SIZE]()
+               {
+                   long sum = 0;
+                   for (int i = 0; i < SIZE; ++i)
+                       sum += (*list)->findFirst(i)->value;
+                   benchSink = sum;
+               });
+}
+
+//------------------------------------------------------------------------------
+
+void addListBenchmarks(BenchmarkRunner& runner)
+{
+    const std::size_t SIZES[] = { 1000, 10000, 100000 };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        // 4 levels are too few for 100000 keys: a run would take seconds
+        if (SIZES[i] < 100000)
+            addListCases<SkipList<int, int, 4> >(runner, "skip_list<4>", SIZES[i]);
+        addListCases<SkipList<int, int, 8> >(runner, "skip_list<8>", SIZES[i]);
+        addListCases<SkipList<int, int, 16> >(runner, "skip_list<16>", SIZES[i]);
+        addListCases<StaticSkipList<int, int, 16> >(runner, "static_skip_list<16>", SIZES[i]);
+        addListCases<StaticSkipList<int, int, 16, HeapNodeAllocator, InlineKeyTower> >(
+                runner, "static_skip_list<16,inline>", SIZES[i]);
+    }
+
+    // virtual against static dispatch on the workload of the old demo
+    addDemoFindCase<SkipList<int, int, 16> >(runner, "skip_list<16>");
+    addDemoFindCase<StaticSkipList<int, int, 16> >(runner, "static_skip_list<16>");
+
+    // a plain list is quadratic, the large size would take minutes
+    for (int i = 0; i < 2; ++i)
+        addListCases<OrderedList<int, int> >(runner, "ordered_list", SIZES[i]);
+}
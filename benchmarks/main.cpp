@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Defines the entry point for the benchmarks.
+///
+/// Usage: benchmarks [--filter TEXT] [--repetitions N] [--json FILE] [--perf]
+///
+/// --perf reads hardware counters around the runs (Linux only). Hops of
+/// skip list searches are reported if the project is configured with
+/// -DCYBERPOLICE_INSTRUMENT=ON.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "suites.h"
+
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    std::string jsonPath;
+    int repetitions = 7;
+    bool perf = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            repetitions = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--perf") == 0)
+            perf = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter TEXT] [--repetitions N] [--json FILE] [--perf]" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        BenchmarkRunner runner(repetitions, filter);
+        if (perf && !runner.enablePerfCounters())
+            std::cerr << "Hardware counters are not available, timing only" << std::endl;
+
+        addListBenchmarks(runner);
+        addConcurrentBenchmarks(runner);
+        addJournalBenchmarks(runner);
+        addTimeStampBenchmarks(runner);
+
+        runner.runAll(std::cout);
+
+        if (!jsonPath.empty())
+        {
+            std::ofstream json(jsonPath);
+            if (!json)
+            {
+                std::cerr << "Couldn't open file " << jsonPath << std::endl;
+                return 1;
+            }
+
+            runner.writeJson(json);
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Declares the benchmark suites.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_SUITES_H_
+#define CYBERPOLICE_SUITES_H_
+
+#include "bench_harness.h"
+
+
+/// Adds insert/find/remove cases for SkipList and OrderedList over integers.
+void addListBenchmarks(BenchmarkRunner& runner);
+
+/// Adds mixed insert/lookup cases for ConcurrentSkipList on 1, 2, 4, ...
+/// threads, up to 16 or the number of cores.
+void addConcurrentBenchmarks(BenchmarkRunner& runner);
+
+/// Adds parse and query cases for JournalNetActivity on generated logs.
+void addJournalBenchmarks(BenchmarkRunner& runner);
+
+/// Adds TimeStamp::parse() against operator>> on the lines of data/test2.log.
+void addTimeStampBenchmarks(BenchmarkRunner& runner);
+
+
+#endif // CYBERPOLICE_SUITES_H_
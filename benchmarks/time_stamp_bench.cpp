@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  time_stamp_bench.cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "suites.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "time_stamp.h"
+
+/// Keeps the parsed stamps alive.
+static volatile long long benchSink;
+
+//------------------------------------------------------------------------------
+
+void addTimeStampBenchmarks(BenchmarkRunner& runner)
+{
+    // the log is short: a run goes over it many times
+    const int PASSES = 500;
+    const std::string LOG_PATH = DATA_DIR "test2.log";
+
+    std::ifstream file(LOG_PATH);
+    if (!file)
+        throw std::runtime_error("Couldn't open file " + LOG_PATH);
+
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::shared_ptr<std::string> text(new std::string());
+    for (int i = 0; i < PASSES; ++i)
+        text->append(content.str());
+
+    const std::size_t lines = std::count(text->begin(), text->end(), '\n');
+
+    // both cases get the whole text and find the line ends themselves;
+    // this one reads it the way the journal used to
+    runner.add("time_stamp/parse/stream", lines, []() { },
+               [text]()
+               {
+                   std::istringstream in(*text);
+                   TimeStamp stamp(1970);
+                   long long sum = 0;
+                   while (in >> stamp)
+                   {
+                       sum += stamp.getSeconds();
+                       in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                   }
+                   benchSink = sum;
+               });
+
+    runner.add("time_stamp/parse/parse", lines, []() { },
+               [text]()
+               {
+                   const char* pos = text->data();
+                   const char* end = pos + text->size();
+                   TimeStamp stamp(1970);
+                   long long sum = 0;
+                   while (pos != end)
+                   {
+                       const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+                       if (lineEnd == nullptr)
+                           lineEnd = end;
+
+                       stamp.parse(pos, lineEnd);
+                       sum += stamp.getSeconds();
+                       pos = lineEnd == end ? end : lineEnd + 1;
+                   }
+                   benchSink = sum;
+               });
+}
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 NodeConcurrentSkipList, ConcurrentSkipList.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef CYBERPOLICE_CONCURRENT_SKIP_LIST_H_
+#define CYBERPOLICE_CONCURRENT_SKIP_LIST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "epoch_reclaimer.h"
+#include "level_generator.h"
+
+
+/*! ****************************************************************************
+ *  \brief A node of the lock-free skip list.
+ *
+ *  Links are atomic words: a pointer to the next node with the lowest bit
+ *  used as a "removed" mark. A marked link means the node owning it is being
+ *  removed from the corresponding level and must not get new successors.
+ *
+ *  The dense level is \a next and \a nextJump is the trailing field cut
+ *  right after nextJump[levelHighest], like the tower of NodeSkipList.
+ ******************************************************************************/
+template <class Value, class Key, int numLevels>
+struct NodeConcurrentSkipList
+{
+    /// Link to the next node with the removal mark.
+    typedef std::atomic<std::uintptr_t> Link;
+
+    /// The removal mark bit of a link.
+    static const std::uintptr_t MARK = 1;
+
+    /// Init the sentinel: a node with the full tower.
+    NodeConcurrentSkipList();
+
+    /// Init with a key, a value and the highest level.
+    NodeConcurrentSkipList(const Key& tkey, const Value& val, int levelHighest);
+
+    /// Returns the number of bytes needed for a node with the given
+    /// highest level.
+    static std::size_t sizeForLevel(int levelHighest)
+    {
+        return sizeof(NodeConcurrentSkipList) - (numLevels - 1 - levelHighest) * sizeof(Link);
+    }
+
+    /// Returns the link of the \a level: -1 is the dense one.
+    Link& link(int level) { return level < 0 ? next : nextJump[level]; }
+
+    /// Returns the next node on the dense level. It may be a removed node.
+    NodeConcurrentSkipList* getNext() const
+    {
+        return reinterpret_cast<NodeConcurrentSkipList*>(next.load() & ~MARK);
+    }
+
+    /// Checks if the node is removed (or is being removed) from the list.
+    bool isRemoved() const { return (next.load() & MARK) != 0; }
+
+    //----<Fields>-----
+    Key key;                    ///< Ordering key.
+    Value value;                ///< Stored value.
+
+    /// Inserting and removing threads hold one reference each, the one
+    /// that drops the last reference retires the node.
+    std::atomic<int> refs;
+
+    /// Highest sparse level, -1 if there are no sparse levels.
+    int levelHighest;
+
+    Link next;                  ///< Dense level.
+    Link nextJump[numLevels];   ///< Sparse levels [0..levelHighest].
+};
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Lock-free skip list for multi-threaded use.
+ *
+ *  Keeps equal keys in the same order as SkipList and has a subset of its
+ *  interface: insert(), removeNext(), findLastLessThan(), findFirst() and
+ *  getPreHead(); there are no iterators, rank/select or allocator policy.
+ *  Any of the methods may be called by many threads simultaneously, so
+ *  removeNext() returns false instead of removing another node when it
+ *  loses the node to another thread. Insertion and search are lock-free,
+ *  removed nodes are deleted by EpochReclaimer when no thread can see them
+ *  anymore.
+ *
+ *  Every thread draws node heights from its own LevelGenerator for each
+ *  list, made on its first insert into the list; the n-th generator of the
+ *  list is seeded with (seed + n). So a list filled by a single thread gets
+ *  the same heights as a SkipList with the same seed. A thread keeps the
+ *  generators of its last GENERATOR_CACHE_SIZE lists; a thread inserting
+ *  into more lists in turn makes a new generator, with the next seed, when
+ *  it comes back to an evicted one.
+ *
+ *  Nodes returned by findLastLessThan() and findFirst() are safe to use only
+ *  inside a Guard taken before the call, if other threads may remove them.
+ *
+ *  Note: the order of equal keys on sparse levels may differ from the dense
+ *  one under contention; none of the searches depends on it.
+ ******************************************************************************/
+template <class Value, class Key, int numLevels>
+class ConcurrentSkipList
+{
+public:
+    /// Alias for corresponding list node.
+    typedef NodeConcurrentSkipList<Value, Key, numLevels> Node;
+
+    /// Critical section, which keeps found nodes from being deleted.
+    typedef EpochReclaimer::Guard Guard;
+
+    /// Number of lists a thread keeps level generators for.
+    static const int GENERATOR_CACHE_SIZE = 4;
+
+public:
+    /// \brief Constructor initializes with a probability.
+    /// \param probability is the probability of each sparse level to appear.
+    ConcurrentSkipList(double probability = 0.5);
+
+    /// \brief Constructor initializes with a probability and a seed of the
+    /// level generators.
+    ConcurrentSkipList(double probability, std::uint64_t seed);
+
+    /// Deletes all the nodes. No other thread may use the list at this point.
+    ~ConcurrentSkipList();
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    /// Inserts a new node after all the nodes with the same key.
+    void insert(const Value& val, const Key& key);
+
+    /// \brief Removes the node following \a nodeBefore.
+    ///
+    /// Throws std::invalid_argument if \a nodeBefore is null or is the last.
+    /// \return false if the node has been removed by another thread first.
+    bool removeNext(Node* nodeBefore);
+
+    /// Finds the last node with a key strictly less than \a key, or the
+    /// sentinel if there is none.
+    Node* findLastLessThan(const Key& key) const;
+
+    /// Finds the first node with a key equal to \a key, nullptr if none.
+    Node* findFirst(const Key& key) const;
+
+    /// Returns the sentinel node.
+    Node* getPreHead() const { return _preHead; }
+
+protected:
+    /// \brief Finds the position for \a key on every level, unlinking removed
+    /// nodes on the way.
+    ///
+    /// \a preds[level + 1] is the last node with the key less than (or not
+    /// greater than, if \a afterEquals) \a key, \a succs[level + 1] follows it.
+    void find(const Key& key, bool afterEquals, Node** preds, Node** succs);
+
+    /// Unlinks all the removed nodes with the given \a key from all levels.
+    void purge(const Key& key);
+
+    /// Drops a reference to the \a node, retires it if it was the last one.
+    void release(Node* node);
+
+    /// Creates a node with a tower of (levelHighest + 1) sparse levels.
+    Node* newNode(const Key& key, const Value& val, int levelHighest);
+
+    /// Deleter for EpochReclaimer.
+    static void deleteNode(void* ptr);
+
+    /// Level generator of a list in the cache of a thread.
+    struct CachedGenerator
+    {
+        CachedGenerator() : owner(0), generator(0.5, 0) {}
+
+        std::uint64_t owner;            ///< Id of the list, 0 if none.
+        LevelGenerator generator;
+    };
+
+    /// Generates the highest level for a new node with the generator of
+    /// the calling thread for this list.
+    int generateLevel();
+
+    /// Links the sentinel to itself on every level.
+    void initPreHead();
+
+    /// Returns a number no other list of this type has had.
+    static std::uint64_t nextId();
+
+    /// Pointer part of a link.
+    static Node* toNode(std::uintptr_t link)
+    {
+        return reinterpret_cast<Node*>(link & ~Node::MARK);
+    }
+
+    /// Unmarked link to the \a node.
+    static std::uintptr_t toLink(Node* node)
+    {
+        return reinterpret_cast<std::uintptr_t>(node);
+    }
+
+protected:
+    /// Sentinel element - placed before first and after last elements.
+    Node* _preHead;
+
+    /// Stores the probability of the next level to appear.
+    double _probability;
+
+    /// Seed of the first level generator, the next ones get the following
+    /// seeds.
+    std::uint64_t _seed;
+
+    /// Tells the thread-local level generators of the lists apart.
+    std::uint64_t _id;
+
+    /// Number of threads that have got a level generator for the list.
+    std::atomic<std::uint64_t> _numGenerators;
+}; // class ConcurrentSkipList
+
+
+//==============================================================================
+
+// Move out "implementation" to a separate header.
+#include "concurrent_skip_list.hpp"
+
+
+#endif // CYBERPOLICE_CONCURRENT_SKIP_LIST_H_
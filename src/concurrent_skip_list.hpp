@@ -0,0 +1,384 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  concurrent_skip_list.h/hpp
+////////////////////////////////////////////////////////////////////////////////
+
+// !!! DO NOT include concurrent_skip_list.h here, 'cause it leads to circular refs. !!!
+
+#include <new>
+#include <stdexcept>
+
+//==============================================================================
+// class NodeConcurrentSkipList
+//==============================================================================
+
+template <class Value, class Key, int numLevels>
+const std::uintptr_t NodeConcurrentSkipList<Value, Key, numLevels>::MARK;
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+NodeConcurrentSkipList<Value, Key, numLevels>::NodeConcurrentSkipList()
+    : key()
+    , value()
+    , refs(1)
+    , levelHighest(numLevels - 1)
+    , next(0)
+{
+    for (int i = 0; i < numLevels; ++i)
+        nextJump[i].store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+NodeConcurrentSkipList<Value, Key, numLevels>::NodeConcurrentSkipList(
+        const Key& tkey, const Value& val, int levelHighest)
+    : key(tkey)
+    , value(val)
+    , refs(2)
+    , levelHighest(levelHighest)
+    , next(0)
+{
+    for (int i = 0; i <= levelHighest; ++i)
+        nextJump[i].store(0, std::memory_order_relaxed);
+}
+
+
+//==============================================================================
+// class ConcurrentSkipList
+//==============================================================================
+
+template <class Value, class Key, int numLevels>
+const int ConcurrentSkipList<Value, Key, numLevels>::GENERATOR_CACHE_SIZE;
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+ConcurrentSkipList<Value, Key, numLevels>::ConcurrentSkipList(double probability)
+    : _probability(probability)
+    , _seed(LevelGenerator::DEFAULT_SEED)
+    , _id(nextId())
+    , _numGenerators(0)
+{
+    initPreHead();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+ConcurrentSkipList<Value, Key, numLevels>::ConcurrentSkipList(double probability,
+                                                              std::uint64_t seed)
+    : _probability(probability)
+    , _seed(seed)
+    , _id(nextId())
+    , _numGenerators(0)
+{
+    initPreHead();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::initPreHead()
+{
+    void* mem = ::operator new(Node::sizeForLevel(numLevels - 1));
+    _preHead = new (mem) Node;
+
+    // the sentinel closes every level
+    for (int level = -1; level < numLevels; ++level)
+        _preHead->link(level).store(toLink(_preHead));
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+ConcurrentSkipList<Value, Key, numLevels>::~ConcurrentSkipList()
+{
+    // removed nodes are already unlinked and belong to the reclaimer
+    Node* run = toNode(_preHead->next.load());
+    while (run != _preHead)
+    {
+        Node* tmp = run;
+        run = toNode(run->next.load());
+        deleteNode(tmp);
+    }
+
+    deleteNode(_preHead);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::insert(const Value& val, const Key& key)
+{
+    Guard guard;
+
+    Node* preds[numLevels + 1];
+    Node* succs[numLevels + 1];
+
+    Node* node = newNode(key, val, generateLevel());
+
+    // the node becomes a part of the list once it is on the dense level
+    for (;;)
+    {
+        find(key, true, preds, succs);
+
+        for (int level = -1; level <= node->levelHighest; ++level)
+            node->link(level).store(toLink(succs[level + 1]), std::memory_order_relaxed);
+
+        std::uintptr_t expected = toLink(succs[0]);
+        if (preds[0]->next.compare_exchange_strong(expected, toLink(node)))
+            break;
+    }
+
+    // sparse levels are linked bottom-up; a concurrent removal stops it
+    for (int level = 0; level <= node->levelHighest; ++level)
+    {
+        for (;;)
+        {
+            Node* succ = succs[level + 1];
+
+            std::uintptr_t own = node->nextJump[level].load();
+            if (own & Node::MARK)
+                goto linked;
+
+            if (toNode(own) != succ
+                && !node->nextJump[level].compare_exchange_strong(own, toLink(succ)))
+            {
+                continue;
+            }
+
+            std::uintptr_t expected = toLink(succ);
+            if (preds[level + 1]->nextJump[level].compare_exchange_strong(expected, toLink(node)))
+                break;
+
+            find(key, true, preds, succs);
+        }
+    }
+
+linked:
+    // the node could have been removed while we were linking it: a level
+    // linked after the remover's purge must be unlinked here
+    if (node->isRemoved())
+        purge(key);
+
+    release(node);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+bool ConcurrentSkipList<Value, Key, numLevels>::removeNext(Node* nodeBefore)
+{
+    if (nodeBefore == nullptr)
+        throw std::invalid_argument("There is no node after the given one");
+
+    Guard guard;
+
+    Node* target = nodeBefore->getNext();
+    if (target == _preHead)
+        throw std::invalid_argument("There is no node after the given one");
+
+    // sparse levels first: no new node can be linked after the target then
+    for (int level = target->levelHighest; level >= 0; --level)
+        target->nextJump[level].fetch_or(Node::MARK);
+
+    // the one who marks the dense level is the remover
+    std::uintptr_t succ = target->next.load();
+    do
+    {
+        if (succ & Node::MARK)
+            return false;
+    }
+    while (!target->next.compare_exchange_weak(succ, succ | Node::MARK));
+
+    purge(target->key);
+    release(target);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+typename ConcurrentSkipList<Value, Key, numLevels>::Node*
+ConcurrentSkipList<Value, Key, numLevels>::findLastLessThan(const Key& key) const
+{
+    Guard guard;
+
+    // removed nodes are stepped over, but not unlinked: searches never write
+    Node* pred = _preHead;
+    for (int level = numLevels - 1; level >= -1; --level)
+    {
+        Node* curr = toNode(pred->link(level).load());
+        while (curr != _preHead)
+        {
+            std::uintptr_t succ = curr->link(level).load();
+            if (!(succ & Node::MARK))
+            {
+                if (!(curr->key < key))
+                    break;
+
+                pred = curr;
+            }
+
+            curr = toNode(succ);
+        }
+    }
+
+    return pred;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+typename ConcurrentSkipList<Value, Key, numLevels>::Node*
+ConcurrentSkipList<Value, Key, numLevels>::findFirst(const Key& key) const
+{
+    Guard guard;
+
+    Node* node = findLastLessThan(key)->getNext();
+    while (node != _preHead && node->isRemoved())
+        node = node->getNext();
+
+    if (node == _preHead || !(node->key == key))
+        return nullptr;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::find(const Key& key, bool afterEquals,
+                                                     Node** preds, Node** succs)
+{
+retry:
+    Node* pred = _preHead;
+    for (int level = numLevels - 1; level >= -1; --level)
+    {
+        Node* curr = toNode(pred->link(level).load());
+        while (curr != _preHead)
+        {
+            std::uintptr_t succ = curr->link(level).load();
+            if (succ & Node::MARK)
+            {
+                // fails if pred is removed itself or got a new successor
+                std::uintptr_t expected = toLink(curr);
+                if (!pred->link(level).compare_exchange_strong(expected, succ & ~Node::MARK))
+                    goto retry;
+
+                curr = toNode(succ);
+                continue;
+            }
+
+            if (afterEquals ? key < curr->key : !(curr->key < key))
+                break;
+
+            pred = curr;
+            curr = toNode(succ);
+        }
+
+        preds[level + 1] = pred;
+        succs[level + 1] = curr;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::purge(const Key& key)
+{
+    Node* preds[numLevels + 1];
+    Node* succs[numLevels + 1];
+
+retry:
+    // strict positions: on each level the nodes with the key follow them
+    find(key, false, preds, succs);
+
+    // equal keys are scanned with a separate pointer, as in SkipList::removeNext
+    for (int level = numLevels - 1; level >= -1; --level)
+    {
+        Node* pred = preds[level + 1];
+        Node* curr = succs[level + 1];
+        while (curr != _preHead && !(key < curr->key))
+        {
+            std::uintptr_t succ = curr->link(level).load();
+            if (succ & Node::MARK)
+            {
+                std::uintptr_t expected = toLink(curr);
+                if (!pred->link(level).compare_exchange_strong(expected, succ & ~Node::MARK))
+                    goto retry;
+            }
+            else
+            {
+                pred = curr;
+            }
+
+            curr = toNode(succ);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::release(Node* node)
+{
+    if (node->refs.fetch_sub(1) == 1)
+        EpochReclaimer::instance().retire(node, &deleteNode);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+typename ConcurrentSkipList<Value, Key, numLevels>::Node*
+ConcurrentSkipList<Value, Key, numLevels>::newNode(const Key& key, const Value& val,
+                                                   int levelHighest)
+{
+    void* mem = ::operator new(Node::sizeForLevel(levelHighest));
+    return new (mem) Node(key, val, levelHighest);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+void ConcurrentSkipList<Value, Key, numLevels>::deleteNode(void* ptr)
+{
+    static_cast<Node*>(ptr)->~Node();
+    ::operator delete(ptr);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+int ConcurrentSkipList<Value, Key, numLevels>::generateLevel()
+{
+    // a generator per thread and list: threads never share a state, and
+    // a thread inserting into a few lists in turn keeps all their sequences
+    static thread_local CachedGenerator cache[GENERATOR_CACHE_SIZE];
+    static thread_local int nextSlot = 0;
+
+    for (int i = 0; i < GENERATOR_CACHE_SIZE; ++i)
+        if (cache[i].owner == _id)
+            return cache[i].generator.generate();
+
+    // the slots are reused in turn
+    CachedGenerator& slot = cache[nextSlot];
+    nextSlot = (nextSlot + 1) % GENERATOR_CACHE_SIZE;
+
+    slot.generator = LevelGenerator(_probability, numLevels, _seed + _numGenerators++);
+    slot.owner = _id;
+
+    return slot.generator.generate();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels>
+std::uint64_t ConcurrentSkipList<Value, Key, numLevels>::nextId()
+{
+    // 0 is never given out: it marks an empty slot of a generator cache
+    static std::atomic<std::uint64_t> lastId(0);
+    return ++lastId;
+}
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  epoch_reclaimer.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "epoch_reclaimer.h"
+
+#include <stdexcept>
+
+//==============================================================================
+// class EpochReclaimer::ThreadHandle
+//==============================================================================
+
+/// Lives in thread local storage: takes a record on the first use and gives
+/// it back when the thread exits. Pending nodes stay in the record and are
+/// collected by its next owner (or by the reclaimer destructor).
+class EpochReclaimer::ThreadHandle
+{
+public:
+    ThreadHandle() : rec(nullptr) {}
+
+    ~ThreadHandle()
+    {
+        if (!rec)
+            return;
+
+        EpochReclaimer::instance().collect(*rec);
+        rec->depth = 0;
+        rec->announced.store(0);
+        rec->taken.store(false);
+    }
+
+    ThreadRecord* rec;
+};
+
+
+//==============================================================================
+// class EpochReclaimer
+//==============================================================================
+
+const int EpochReclaimer::MAX_THREADS;
+const std::size_t EpochReclaimer::RETIRE_THRESHOLD;
+const std::size_t EpochReclaimer::CACHE_LINE_SIZE;
+
+//------------------------------------------------------------------------------
+
+EpochReclaimer& EpochReclaimer::instance()
+{
+    static EpochReclaimer reclaimer;
+    return reclaimer;
+}
+
+//------------------------------------------------------------------------------
+
+EpochReclaimer::EpochReclaimer()
+    : _epoch(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+EpochReclaimer::~EpochReclaimer()
+{
+    // all threads are gone: nothing is reachable anymore
+    for (int i = 0; i < MAX_THREADS; ++i)
+    {
+        std::vector<Retired>& limbo = _records[i].limbo;
+        for (size_t j = 0; j < limbo.size(); ++j)
+            limbo[j].deleter(limbo[j].ptr);
+        limbo.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+EpochReclaimer::ThreadRecord& EpochReclaimer::getRecord()
+{
+    static thread_local ThreadHandle handle;
+    if (handle.rec)
+        return *handle.rec;
+
+    for (int i = 0; i < MAX_THREADS; ++i)
+    {
+        bool expected = false;
+        if (_records[i].taken.compare_exchange_strong(expected, true))
+        {
+            handle.rec = &_records[i];
+            return *handle.rec;
+        }
+    }
+
+    throw std::runtime_error("EpochReclaimer: too many threads");
+}
+
+//------------------------------------------------------------------------------
+
+void EpochReclaimer::enter()
+{
+    ThreadRecord& rec = getRecord();
+    if (rec.depth++ > 0)
+        return;
+
+    // the announcement must be visible before any shared node is read;
+    // both are sequentially consistent
+    rec.announced.store((_epoch.load() << 1) | 1);
+}
+
+//------------------------------------------------------------------------------
+
+void EpochReclaimer::leave()
+{
+    ThreadRecord& rec = getRecord();
+    if (--rec.depth == 0)
+        rec.announced.store(0);
+}
+
+//------------------------------------------------------------------------------
+
+void EpochReclaimer::retire(void* ptr, Deleter deleter)
+{
+    ThreadRecord& rec = getRecord();
+
+    Retired retired = { ptr, deleter, _epoch.load() };
+    rec.limbo.push_back(retired);
+
+    if (rec.limbo.size() % RETIRE_THRESHOLD == 0)
+    {
+        tryAdvance();
+        collect(rec);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t EpochReclaimer::collect()
+{
+    ThreadRecord& rec = getRecord();
+
+    // two steps are needed for the nodes retired in the current epoch
+    tryAdvance();
+    tryAdvance();
+    collect(rec);
+
+    return rec.limbo.size();
+}
+
+//------------------------------------------------------------------------------
+
+void EpochReclaimer::tryAdvance()
+{
+    std::uint64_t epoch = _epoch.load();
+    std::uint64_t current = (epoch << 1) | 1;
+
+    for (int i = 0; i < MAX_THREADS; ++i)
+    {
+        std::uint64_t announced = _records[i].announced.load();
+        if (announced != 0 && announced != current)
+            return;                     // somebody is still in an older epoch
+    }
+
+    _epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+//------------------------------------------------------------------------------
+
+void EpochReclaimer::collect(ThreadRecord& rec)
+{
+    std::uint64_t epoch = _epoch.load();
+    std::vector<Retired>& limbo = rec.limbo;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < limbo.size(); ++i)
+    {
+        if (limbo[i].epoch + 2 <= epoch)
+            limbo[i].deleter(limbo[i].ptr);
+        else
+            limbo[kept++] = limbo[i];
+    }
+
+    limbo.resize(kept);
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 EpochReclaimer.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_EPOCH_RECLAIMER_H_
+#define CYBERPOLICE_EPOCH_RECLAIMER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/*! ****************************************************************************
+ *  \brief Epoch-based memory reclamation for lock-free structures.
+ *
+ *  A thread reads shared nodes only inside a critical section (see Guard).
+ *  A node unlinked from a structure is passed to retire() and is deleted only
+ *  when every thread that could still see it has left its critical section:
+ *  the global epoch is advanced when all active threads have announced the
+ *  current one, and nodes retired in epoch e are deleted in epoch e + 2.
+ *
+ *  There is a single reclaimer per process, shared by all lock-free lists.
+ ******************************************************************************/
+class EpochReclaimer
+{
+public:
+    // Constants
+
+    /// Maximum number of threads using the reclaimer simultaneously.
+    static const int MAX_THREADS = 256;
+
+    /// Retired nodes are collected every RETIRE_THRESHOLD retirements.
+    static const std::size_t RETIRE_THRESHOLD = 64;
+
+    /// Size of a cache line: records of different threads never share one.
+    static const std::size_t CACHE_LINE_SIZE = 64;
+
+public:
+    /// Function used to delete a retired node.
+    typedef void (*Deleter)(void* ptr);
+
+    /// \brief RAII critical section.
+    ///
+    /// Guards may be nested.
+    class Guard
+    {
+    public:
+        Guard() { EpochReclaimer::instance().enter(); }
+        ~Guard() { EpochReclaimer::instance().leave(); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+public:
+    /// Returns the process-wide reclaimer.
+    static EpochReclaimer& instance();
+
+    /// Enters a critical section of the calling thread.
+    void enter();
+
+    /// Leaves a critical section of the calling thread.
+    void leave();
+
+    /// Schedules \a ptr for deletion by \a deleter.
+    void retire(void* ptr, Deleter deleter);
+
+    /// Deletes all the nodes retired by the calling thread that are not
+    /// reachable anymore. Returns the number of nodes still waiting.
+    std::size_t collect();
+
+    /// Deletes all the retired nodes of all threads.
+    ~EpochReclaimer();
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+protected:
+    /// A node waiting for deletion.
+    struct Retired
+    {
+        void* ptr;
+        Deleter deleter;
+        std::uint64_t epoch;            ///< Global epoch at retirement.
+    };
+
+    /// \brief Per-thread state.
+    ///
+    /// Every Guard writes \a announced and \a depth of its thread, so each
+    /// record takes whole cache lines of its own.
+    struct alignas(CACHE_LINE_SIZE) ThreadRecord
+    {
+        ThreadRecord() : announced(0), taken(false), depth(0) {}
+
+        /// (epoch << 1) | 1 inside a critical section, 0 outside.
+        std::atomic<std::uint64_t> announced;
+
+        /// Whether the record belongs to a live thread.
+        std::atomic<bool> taken;
+
+        /// Nesting depth of critical sections. Owner only.
+        int depth;
+
+        /// Nodes retired by the owner. Owner only.
+        std::vector<Retired> limbo;
+    };
+
+    /// Binds the calling thread to a record for the thread's lifetime.
+    class ThreadHandle;
+    friend class ThreadHandle;
+
+protected:
+    EpochReclaimer();
+
+    /// Returns the record of the calling thread.
+    ThreadRecord& getRecord();
+
+    /// Advances the global epoch if all active threads are in it.
+    void tryAdvance();
+
+    /// Deletes the nodes of \a rec retired at least two epochs ago.
+    void collect(ThreadRecord& rec);
+
+protected:
+    /// Current global epoch.
+    std::atomic<std::uint64_t> _epoch;
+
+    /// Records of threads. Records are reused after a thread exits, together
+    /// with its pending nodes.
+    ThreadRecord _records[MAX_THREADS];
+}; // class EpochReclaimer
+
+
+#endif // CYBERPOLICE_EPOCH_RECLAIMER_H_
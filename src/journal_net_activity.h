@@ -20,8 +20,19 @@
 #define CYBERPOLICE_JOURNAL_NET_ACTIVITY_H_
 
 
+#include <cstddef>
+#include <deque>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "skip_list.h"
+#include "log_tokenizer.h"
+#include "mapped_file.h"
 #include "net_activity.h"
+#include "output_buffer.h"
+#include "string_interner.h"
 #include "time_stamp.h"
 
 
@@ -33,21 +44,75 @@ class JournalNetActivity
 {
 public:
     /// Alias for typed SkipList.
-    typedef SkipList<NetActivity, TimeStamp, numLevels> NetActivityList;
+    ///
+    /// A journal never removes records, so the nodes are taken from an arena
+    /// and released all at once with the journal. The list is never used
+    /// through OrderedList, so its calls are statically bound.
+    ///
+    /// Users and hosts repeat a lot, so nodes keep only their ids, the
+    /// strings are in _users and _hosts.
+    typedef StaticSkipList<NetActivityRecord, TimeStamp, numLevels, ArenaNodeAllocator> NetActivityList;
+
+    /// An event of a single host or a single user.
+    struct IndexEntry
+    {
+        TimeStamp timestamp;
+
+        /// Id of the other side: a user for a host, a host for a user.
+        StringInterner::Id other;
+    };
+
+    /// \brief Time-ordered events of a single host or a single user.
+    ///
+    /// Equal timestamps go in the order of the journal, since all the
+    /// indices get the records in the same order. There are as many indices
+    /// as users and hosts, mostly short ones, so a sorted vector is enough:
+    /// a skip list would add an arena and a full-height sentinel to each of
+    /// them. Records are appended as they come and the indices that got
+    /// late ones are stable-sorted once a log is parsed, so a log in any
+    /// order takes O(n log n) time.
+    typedef std::vector<IndexEntry> IndexList;
 
 public:
 
     /// Just dumps the whole journal to the \a out stream.
     void dumpJournal(std::ostream& out);
     
+    /// \brief Reads the whole log from the \a in stream.
+    ///
+    /// Records of a log are mostly ordered, so they take the fast path of
+    /// SkipList::insert() and are appended with no searching.
+    ///
+    /// A record is a line "timestamp user host". Timestamps in the fixed
+    /// format are read with TimeStamp::parse(), other lines go through the
+    /// stream operators.
     void parseLogFromStream(std::istream& in);
     
     
+    /// \brief Reads the whole log from the \a size characters at \a data,
+    /// the way parseLogFromStream() does.
+    ///
+    /// Lines are split and parsed right in place, the characters are read
+    /// once and only user and host names are copied into the dictionaries.
+    ///
+    /// With \a numThreads > 1 (0 is one per core) the text is cut into
+    /// chunks at line ends, the chunks are parsed and sorted by their own
+    /// threads and then merged into the lists. The result is the same as
+    /// for a single thread: records with equal stamps keep the order of the
+    /// log.
+    void parseLogFromBuffer(const char* data, std::size_t size, unsigned numThreads = 1);
+
     /// Reads the whole log from the file on \a fullpath.
-    void parseLog(const std::string& fullpath);
+    ///
+    /// The file is mapped into memory and parsed with parseLogFromBuffer()
+    /// on \a numThreads threads, so it is never copied as a whole.
+    void parseLog(const std::string& fullpath, unsigned numThreads = 1);
 
     /// Outputs all net activity between \a from and \a to (including borders).
     /// Uses given ostream for output!!!
+    ///
+    /// Borders are exact instants: for a log with fractions of a second,
+    /// \a to = 10:33:04 does not include 10:33:04.5.
     /// 
     /// If `from` > `to` throws std::invalid_argument
     ///
@@ -60,14 +125,200 @@ public:
     /// Empty output is "" without new line. 
     /// 
     /// Net Activities with equal TimeStamps should go in the same order as they were in the journal.
+    ///
+    /// Uses the index of the host, so it takes O(log n + k) time, k being
+    /// the number of printed records.
     void outputSuspiciousActivities(const std::string& site,
                                     const TimeStamp& from,
                                     const TimeStamp& to,
                                     std::ostream& out) const;
 
+    /// \brief Outputs the same text as outputSuspiciousActivities(site,
+    /// from, to, out) to the \a sink.
+    ///
+    /// Lines end with '\n' and nothing is flushed: the text is collected in
+    /// a buffer and given to the sink in large chunks, so a query with many
+    /// rows takes a few writes instead of one per row. To print to a stream,
+    /// pass OutputBuffer::streamSink(out) and flush the stream once after.
+    void outputSuspiciousActivities(const std::string& site,
+                                    const TimeStamp& from,
+                                    const TimeStamp& to,
+                                    const OutputBuffer::Sink& sink) const;
+
+    /// \brief Outputs all net activity of the \a user between \a from and
+    /// \a to (including borders) in O(log n + k) time.
+    ///
+    /// The format and the order are the same as for
+    /// outputSuspiciousActivities(). If `from` > `to` throws
+    /// std::invalid_argument.
+    void outputUserActivities(const std::string& user,
+                              const TimeStamp& from,
+                              const TimeStamp& to,
+                              std::ostream& out) const;
+
+    /// Outputs the same text as outputUserActivities(user, from, to, out)
+    /// to the \a sink, the way the sink version of
+    /// outputSuspiciousActivities() does.
+    void outputUserActivities(const std::string& user,
+                              const TimeStamp& from,
+                              const TimeStamp& to,
+                              const OutputBuffer::Sink& sink) const;
+
+protected:
+    /// A parsed line; names point into the log or into a storage of names.
+    struct LineRecord
+    {
+        /// Not the default stamp: that one reads the clock.
+        LineRecord() : timestamp(1970), user(nullptr), userLen(0), host(nullptr), hostLen(0) {}
+
+        TimeStamp timestamp;
+        const char* user;
+        std::size_t userLen;
+        const char* host;
+        std::size_t hostLen;
+    };
+
+    /// Records of a part of a log parsed by a single thread.
+    struct ParsedChunk
+    {
+        /// Records sorted by stamps.
+        std::vector<LineRecord> records;
+
+        /// Names that are not in the log as is.
+        std::deque<std::string> names;
+    };
+
+    /// Chunks smaller than this are not worth a thread.
+    static const std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+    /// Checks if the record \a a has an earlier stamp than \a b.
+    static bool earlierRecord(const LineRecord& a, const LineRecord& b)
+    {
+        return a.timestamp < b.timestamp;
+    }
+
+    /// The stamp of the next record of a chunk being merged.
+    struct MergeHead
+    {
+        TimeStamp timestamp;
+        std::size_t chunk;
+    };
+
+    /// Orders the heads of a merge so that the top of a priority queue is the
+    /// earliest head; of equal ones, the head of the first chunk.
+    struct LaterHead
+    {
+        bool operator()(const MergeHead& a, const MergeHead& b) const
+        {
+            if (b.timestamp < a.timestamp)
+                return true;
+            return !(a.timestamp < b.timestamp) && a.chunk > b.chunk;
+        }
+    };
+
+    /// Parses the line [\a begin, \a end) with no line separator into
+    /// \a record; names of a line that is not in the fixed format are kept
+    /// in \a names. Returns false for blank and malformed lines.
+    static bool parseLine(const char* begin, const char* end,
+                          LineRecord& record, std::deque<std::string>& names);
+
+    /// Parses the lines [\a begin, \a end) into the \a chunk and sorts it.
+    static void parseChunk(const char* begin, const char* end, ParsedChunk& chunk);
+
+    /// Adds the records of sorted chunks in the order of their stamps and,
+    /// for equal stamps, in the order of the chunks.
+    void mergeChunks(const std::vector<ParsedChunk>& chunks);
+
+    /// Checks if the entry \a a has an earlier stamp than \a stamp.
+    static bool entryEarlier(const IndexEntry& a, const TimeStamp& stamp)
+    {
+        return a.timestamp < stamp;
+    }
+
+    /// Checks if \a stamp is earlier than the stamp of the entry \a b.
+    static bool stampEarlier(const TimeStamp& stamp, const IndexEntry& b)
+    {
+        return stamp < b.timestamp;
+    }
+
+    /// \brief Adds an event to the index \a id of \a indices, growing them
+    /// if needed.
+    ///
+    /// The entry is appended; if it is earlier than the last one, \a id is
+    /// added to \a unsorted, and the index is sorted by sortIndices().
+    static void addToIndex(std::vector<IndexList>& indices, StringInterner::Id id,
+                           const TimeStamp& timestamp, StringInterner::Id other,
+                           std::vector<StringInterner::Id>& unsorted);
+
+    /// Sorts the indices that got late records, keeping equal stamps in
+    /// the journal order.
+    void sortIndices();
+
+    /// Sorts the indices of \a unsorted ids and clears the list.
+    static void sortIndices(std::vector<IndexList>& indices,
+                            std::vector<StringInterner::Id>& unsorted);
+
+    /// Checks if the entry \a a has an earlier stamp than \a b.
+    static bool earlierEntry(const IndexEntry& a, const IndexEntry& b)
+    {
+        return a.timestamp < b.timestamp;
+    }
+
+    /// Parses the log like parseLogFromBuffer() does, but leaves the
+    /// indices unsorted.
+    void parseBuffer(const char* data, std::size_t size, unsigned numThreads);
+
+    /// Adds a parsed record to the journal.
+    void addRecord(const LineRecord& record);
+
+    /// Adds a record with the given user and host to the journal.
+    void addRecord(const TimeStamp& timestamp,
+                   const char* user, std::size_t userLen,
+                   const char* host, std::size_t hostLen);
+
+    /// Writes the record as "timestamp user host" with no line separator.
+    void writeRecord(const TimeStamp& timestamp,
+                     StringInterner::Id user, StringInterner::Id host,
+                     TimeStampFormatter& formatter, OutputBuffer& out) const;
+
+    /// \brief Writes the records of \a name in [\a from, \a to] from its
+    /// index to the \a sink, a line each.
+    ///
+    /// \a names and \a indices are of hosts if \a byHost, of users
+    /// otherwise. If \a flushEachLine is given, every line is flushed to it
+    /// as std::endl would do.
+    void outputIndexRange(const StringInterner& names,
+                          const std::vector<IndexList>& indices,
+                          bool byHost,
+                          const std::string& name,
+                          const TimeStamp& from,
+                          const TimeStamp& to,
+                          const OutputBuffer::Sink& sink,
+                          std::ostream* flushEachLine) const;
+
 protected:
     /// Log storage.
     NetActivityList _journal;
+
+    /// Dictionary of user names.
+    StringInterner _users;
+
+    /// Dictionary of hosts.
+    StringInterner _hosts;
+
+    /// Indices of the hosts, by host ids.
+    std::vector<IndexList> _hostIndex;
+
+    /// Indices of the users, by user ids.
+    std::vector<IndexList> _userIndex;
+
+    /// Hosts whose indices got late records since they were sorted, with
+    /// repeats.
+    std::vector<StringInterner::Id> _unsortedHosts;
+
+    /// Users whose indices got late records since they were sorted, with
+    /// repeats.
+    std::vector<StringInterner::Id> _unsortedUsers;
 };
 
 
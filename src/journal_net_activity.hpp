@@ -11,64 +11,365 @@
 
 // !!! DO NOT include journal_net_activity.h here, 'cause it leads to circular refs. !!!
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 //==============================================================================
 // class JournalNetActivity
 //==============================================================================
 
 template <int numLevels>
-void JournalNetActivity<numLevels>::parseLog(const std::string& fullpath)
+void JournalNetActivity<numLevels>::parseLog(const std::string& fullpath, unsigned numThreads)
 {
-    // пытаемся открыть файл для чтения
-    std::ifstream fin(fullpath);    // opens the file
-    if (!fin)
-        throw std::logic_error("Couldn't open file " + fullpath);
-    
-    parseLogFromStream(fin);
+    // the file is parsed right in the mapping, names are copied only once
+    // into the dictionaries, so the mapping is not needed afterwards
+    MappedFile file(fullpath);
+
+    parseLogFromBuffer(file.data(), file.size(), numThreads);
 }
 
+//------------------------------------------------------------------------------
+
 template <int numLevels>
 void JournalNetActivity<numLevels>::parseLogFromStream(std::istream& in)
 {
-    TimeStamp timestamp;            // dummy
-    NetActivity netactivity;        // dummy
+    std::string line;
+    LineRecord record;
+    std::deque<std::string> names;
 
-    while (in)
+    // the records added before a throw must be found as well
+    try
     {
-        in >> timestamp;
-        if (!in)
-            break;
+        while (std::getline(in, line))
+        {
+            if (parseLine(line.data(), line.data() + line.size(), record, names))
+                addRecord(record);
 
-        in >> netactivity.user;
-        if (!in)
-            break;
+            names.clear();
+        }
+    }
+    catch (...)
+    {
+        sortIndices();
+        throw;
+    }
 
-        in >> netactivity.host;
-        if (!in)
-            break;
+    sortIndices();
+}
+
+//------------------------------------------------------------------------------
 
-        _journal.insert(netactivity, timestamp);
+template <int numLevels>
+void JournalNetActivity<numLevels>::parseLogFromBuffer(const char* data, std::size_t size,
+                                                       unsigned numThreads)
+{
+    try
+    {
+        parseBuffer(data, size, numThreads);
+    }
+    catch (...)
+    {
+        sortIndices();
+        throw;
     }
+
+    sortIndices();
 }
 
 //------------------------------------------------------------------------------
 
 template <int numLevels>
-void JournalNetActivity<numLevels>::dumpJournal(std::ostream& out)
+void JournalNetActivity<numLevels>::parseBuffer(const char* data, std::size_t size,
+                                                unsigned numThreads)
+{
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // not worth a thread: lines go straight to the lists
+    if (numThreads == 1 || size < MIN_CHUNK_SIZE * 2)
+    {
+        const char* end = data + size;
+        LineRecord record;
+        std::deque<std::string> names;
+
+        while (data != end)
+        {
+            const char* eol = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            if (eol == nullptr)
+                eol = end;
+
+            if (parseLine(data, eol, record, names))
+                addRecord(record);
+
+            names.clear();
+            data = eol == end ? end : eol + 1;
+        }
+
+        return;
+    }
+
+    std::size_t numChunks = std::min<std::size_t>(numThreads, size / MIN_CHUNK_SIZE);
+    std::vector<ParsedChunk> chunks(numChunks);
+    std::vector<std::exception_ptr> errors(numChunks);
+    std::vector<std::thread> threads;
+    threads.reserve(numChunks);
+
+    // chunks end right after a line end, the last one takes the rest
+    const char* end = data + size;
+    const char* chunkBegin = data;
+    for (std::size_t i = 0; i < numChunks; ++i)
+    {
+        const char* chunkEnd = end;
+        if (i + 1 < numChunks)
+        {
+            const char* cut = std::max(chunkBegin, data + size / numChunks * (i + 1));
+            chunkEnd = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+            chunkEnd = chunkEnd == nullptr ? end : chunkEnd + 1;
+        }
+
+        ParsedChunk* chunk = &chunks[i];
+        std::exception_ptr* error = &errors[i];
+        auto work = [chunkBegin, chunkEnd, chunk, error]()
+        {
+            try
+            {
+                parseChunk(chunkBegin, chunkEnd, *chunk);
+            }
+            catch (...)
+            {
+                *error = std::current_exception();
+            }
+        };
+
+        // if no more threads can be started, the chunk is parsed right here:
+        // the started ones must be joined anyway
+        try
+        {
+            threads.emplace_back(work);
+        }
+        catch (...)
+        {
+            work();
+        }
+
+        chunkBegin = chunkEnd;
+    }
+
+    for (std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    for (std::size_t i = 0; i < errors.size(); ++i)
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+
+    mergeChunks(chunks);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+bool JournalNetActivity<numLevels>::parseLine(const char* begin, const char* end,
+                                              LineRecord& record,
+                                              std::deque<std::string>& names)
+{
+    begin = LogTokenizer::skipSpaces(begin, end);
+    if (begin == end)
+        return false;
+
+    const char* pos = record.timestamp.parse(begin, end);
+    if (pos == nullptr)
+    {
+        // not the fixed format: let the stream operators deal with it
+        NetActivity netactivity;
+        std::istringstream line(std::string(begin, end));
+        if (!(line >> record.timestamp >> netactivity.user >> netactivity.host))
+            return false;
+
+        names.push_back(netactivity.user);
+        names.push_back(netactivity.host);
+        record.user = names[names.size() - 2].data();
+        record.userLen = names[names.size() - 2].size();
+        record.host = names.back().data();
+        record.hostLen = names.back().size();
+        return true;
+    }
+
+    const char* userBegin = LogTokenizer::skipSpaces(pos, end);
+    const char* userEnd = LogTokenizer::skipWord(userBegin, end);
+    const char* hostBegin = LogTokenizer::skipSpaces(userEnd, end);
+    const char* hostEnd = LogTokenizer::skipWord(hostBegin, end);
+    if (userBegin == userEnd || hostBegin == hostEnd)
+        return false;
+
+    record.user = userBegin;
+    record.userLen = userEnd - userBegin;
+    record.host = hostBegin;
+    record.hostLen = hostEnd - hostBegin;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::parseChunk(const char* begin, const char* end,
+                                               ParsedChunk& chunk)
 {
-    typename NetActivityList::Node* prehead = _journal.getPreHead();
-    typename NetActivityList::Node* run = prehead;
+    LineRecord record;
 
-    // prehead is placed before the first and after the last element
-    // So it serves two roles.
-    while (run->next != prehead)
+    while (begin != end)
+    {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (eol == nullptr)
+            eol = end;
+
+        if (parseLine(begin, eol, record, chunk.names))
+            chunk.records.push_back(record);
+
+        begin = eol == end ? end : eol + 1;
+    }
+
+    // logs are mostly ordered, so most chunks need no sorting at all;
+    // a stable sort keeps equal stamps in the order of the file
+    if (!std::is_sorted(chunk.records.begin(), chunk.records.end(), earlierRecord))
+        std::stable_sort(chunk.records.begin(), chunk.records.end(), earlierRecord);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::mergeChunks(const std::vector<ParsedChunk>& chunks)
+{
+    // the earliest head; of equal ones, the head of the first chunk, as it
+    // comes first in the file
+    std::priority_queue<MergeHead, std::vector<MergeHead>, LaterHead> queue;
+    std::vector<std::size_t> heads(chunks.size(), 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
     {
-        run = run->next;
-        out << run->key;
-        out << " ";
-        out << run->value;
+        if (!chunks[i].records.empty())
+            queue.push(MergeHead{chunks[i].records.front().timestamp, i});
     }
+
+    while (!queue.empty())
+    {
+        std::size_t best = queue.top().chunk;
+        queue.pop();
+
+        addRecord(chunks[best].records[heads[best]++]);
+        if (heads[best] < chunks[best].records.size())
+            queue.push(MergeHead{chunks[best].records[heads[best]].timestamp, best});
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::addRecord(const LineRecord& record)
+{
+    addRecord(record.timestamp, record.user, record.userLen, record.host, record.hostLen);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::addRecord(const TimeStamp& timestamp,
+                                              const char* user, std::size_t userLen,
+                                              const char* host, std::size_t hostLen)
+{
+    NetActivityRecord record;
+    record.user = _users.intern(user, userLen);
+    record.host = _hosts.intern(host, hostLen);
+
+    _journal.insert(record, timestamp);
+
+    addToIndex(_hostIndex, record.host, timestamp, record.user, _unsortedHosts);
+    addToIndex(_userIndex, record.user, timestamp, record.host, _unsortedUsers);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::addToIndex(std::vector<IndexList>& indices,
+                                               StringInterner::Id id,
+                                               const TimeStamp& timestamp,
+                                               StringInterner::Id other,
+                                               std::vector<StringInterner::Id>& unsorted)
+{
+    if (indices.size() <= id)
+        indices.resize(id + 1);
+
+    IndexList& index = indices[id];
+    if (!index.empty() && timestamp < index.back().timestamp)
+        unsorted.push_back(id);
+
+    IndexEntry entry = {timestamp, other};
+    index.push_back(entry);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::sortIndices()
+{
+    sortIndices(_hostIndex, _unsortedHosts);
+    sortIndices(_userIndex, _unsortedUsers);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::sortIndices(std::vector<IndexList>& indices,
+                                                std::vector<StringInterner::Id>& unsorted)
+{
+    std::sort(unsorted.begin(), unsorted.end());
+    unsorted.erase(std::unique(unsorted.begin(), unsorted.end()), unsorted.end());
+
+    // entries were appended in the journal order, stable sorting keeps it
+    // for equal stamps
+    for (std::size_t i = 0; i < unsorted.size(); ++i)
+        std::stable_sort(indices[unsorted[i]].begin(), indices[unsorted[i]].end(), earlierEntry);
+
+    unsorted.clear();
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::writeRecord(const TimeStamp& timestamp,
+                                                StringInterner::Id user,
+                                                StringInterner::Id host,
+                                                TimeStampFormatter& formatter,
+                                                OutputBuffer& out) const
+{
+    char buf[TimeStamp::SIZE_MAXSTRTIME];
+    out.write(buf, formatter.format(timestamp, buf) - buf);
+
+    const std::string& userName = _users.get(user);
+    const std::string& hostName = _hosts.get(host);
+
+    out.put(' ');
+    out.write(userName.data(), userName.size());
+    out.put(' ');
+    out.write(hostName.data(), hostName.size());
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::dumpJournal(std::ostream& out)
+{
+    typedef typename NetActivityList::const_iterator Iterator;
+
+    TimeStampFormatter formatter;
+    OutputBuffer buffer(OutputBuffer::streamSink(out));
+
+    for (Iterator it = _journal.begin(), end = _journal.end(); it != end; ++it)
+        writeRecord(it->key, it->value.user, it->value.host, formatter, buffer);
+
+    buffer.flush();
 }
 
 //------------------------------------------------------------------------------
@@ -80,5 +381,91 @@ void JournalNetActivity<numLevels>::outputSuspiciousActivities(
         const TimeStamp& timeTo,
         std::ostream& out) const
 {
-    // TODO: Implement this method!
-}
\ No newline at end of file
+    outputIndexRange(_hosts, _hostIndex, true, hostSuspicious, timeFrom, timeTo,
+                     OutputBuffer::streamSink(out), &out);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::outputUserActivities(
+        const std::string& userName,
+        const TimeStamp& timeFrom,
+        const TimeStamp& timeTo,
+        std::ostream& out) const
+{
+    outputIndexRange(_users, _userIndex, false, userName, timeFrom, timeTo,
+                     OutputBuffer::streamSink(out), &out);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::outputSuspiciousActivities(
+        const std::string& hostSuspicious,
+        const TimeStamp& timeFrom,
+        const TimeStamp& timeTo,
+        const OutputBuffer::Sink& sink) const
+{
+    outputIndexRange(_hosts, _hostIndex, true, hostSuspicious, timeFrom, timeTo, sink, nullptr);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::outputUserActivities(
+        const std::string& userName,
+        const TimeStamp& timeFrom,
+        const TimeStamp& timeTo,
+        const OutputBuffer::Sink& sink) const
+{
+    outputIndexRange(_users, _userIndex, false, userName, timeFrom, timeTo, sink, nullptr);
+}
+
+//------------------------------------------------------------------------------
+
+template <int numLevels>
+void JournalNetActivity<numLevels>::outputIndexRange(
+        const StringInterner& names,
+        const std::vector<IndexList>& indices,
+        bool byHost,
+        const std::string& name,
+        const TimeStamp& timeFrom,
+        const TimeStamp& timeTo,
+        const OutputBuffer::Sink& sink,
+        std::ostream* flushEachLine) const
+{
+    typedef typename IndexList::const_iterator Iterator;
+
+    if (timeTo < timeFrom)
+        throw std::invalid_argument("Time range is empty: from > to");
+
+    // an unknown name has no records at all
+    StringInterner::Id id = names.find(name);
+    if (id == StringInterner::NOT_FOUND)
+        return;
+
+    const IndexList& index = indices[id];
+    TimeStampFormatter formatter;
+    OutputBuffer buffer(sink);
+
+    Iterator end = std::upper_bound(index.begin(), index.end(), timeTo, stampEarlier);
+    for (Iterator it = std::lower_bound(index.begin(), index.end(), timeFrom, entryEarlier);
+         it != end; ++it)
+    {
+        if (byHost)
+            writeRecord(it->timestamp, it->other, id, formatter, buffer);
+        else
+            writeRecord(it->timestamp, id, it->other, formatter, buffer);
+        buffer.put('\n');
+
+        // what std::endl does
+        if (flushEachLine != nullptr)
+        {
+            buffer.flush();
+            flushEachLine->flush();
+        }
+    }
+
+    buffer.flush();
+}
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 KeyPrefix.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_KEY_PREFIX_H_
+#define CYBERPOLICE_KEY_PREFIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+
+/*! ****************************************************************************
+ *  \brief Maps keys to 64-bit numbers keeping their order.
+ *
+ *  A specialization has
+ *      static const bool exact;
+ *      static std::uint64_t get(const Key& key);
+ *  where a < b implies get(a) <= get(b); if \a exact, equal numbers also
+ *  mean equal keys, otherwise such keys must be compared themselves.
+ *
+ *  There is no general definition: a key type needs a specialization to be
+ *  used with InlineKeyTower, see skip_list.h.
+ ******************************************************************************/
+template <class Key, class Enable = void>
+struct KeyPrefix;
+
+//==============================================================================
+
+
+/// Integers: signed ones are biased so that the smallest one becomes 0.
+template <class Key>
+struct KeyPrefix<Key, typename std::enable_if<std::is_integral<Key>::value>::type>
+{
+    static_assert(sizeof(Key) <= sizeof(std::uint64_t), "The key does not fit into a prefix");
+
+    static const bool exact = true;
+
+    static std::uint64_t get(Key key)
+    {
+        // a signed key is sign-extended, flipping the top bit orders it
+        const std::uint64_t BIAS = std::is_signed<Key>::value ? std::uint64_t(1) << 63 : 0;
+        return static_cast<std::uint64_t>(key) ^ BIAS;
+    }
+};
+
+//==============================================================================
+
+
+/// Strings: the first 8 characters, the first one in the highest byte.
+template <>
+struct KeyPrefix<std::string>
+{
+    static const bool exact = false;
+
+    static std::uint64_t get(const std::string& key)
+    {
+        // std::string compares characters as unsigned ones; a shorter key
+        // is padded with zeroes, so a prefix of a key is not greater
+        std::uint64_t prefix = 0;
+        std::size_t size = key.size() < 8 ? key.size() : 8;
+        for (std::size_t i = 0; i < size; ++i)
+            prefix |= std::uint64_t(static_cast<unsigned char>(key[i])) << (56 - 8 * i);
+
+        return prefix;
+    }
+};
+
+
+#endif // CYBERPOLICE_KEY_PREFIX_H_
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  level_generator.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "level_generator.h"
+
+#include <stdexcept>
+
+//==============================================================================
+// class LevelGenerator
+//==============================================================================
+
+const std::uint64_t LevelGenerator::DEFAULT_SEED;
+const int LevelGenerator::MAX_LEVELS;
+
+//------------------------------------------------------------------------------
+
+LevelGenerator::LevelGenerator(double probability, int numLevels, std::uint64_t seed)
+    : _numLevels(numLevels)
+    , _isHalf(probability == 0.5)
+{
+    if (numLevels < 0 || numLevels > MAX_LEVELS)
+        throw std::invalid_argument("Too many levels for LevelGenerator");
+
+    _levelCap = 1ULL << numLevels;
+
+    const double scale = 9007199254740992.0;        // 2^53
+    double threshold = 1.0;
+    for (int i = 0; i < numLevels; ++i)
+    {
+        threshold *= probability;
+        if (threshold < 0)
+            threshold = 0;
+
+        _thresholds[i] = threshold >= 1.0 ? (1ULL << 53)
+                                          : static_cast<std::uint64_t>(threshold * scale);
+    }
+
+    this->seed(seed);
+}
+
+//------------------------------------------------------------------------------
+
+void LevelGenerator::seed(std::uint64_t seed)
+{
+    // splitmix64 spreads close seeds over the whole state space
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    _state = z != 0 ? z : DEFAULT_SEED;
+}
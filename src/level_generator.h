@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 LevelGenerator.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_LEVEL_GENERATOR_H_
+#define CYBERPOLICE_LEVEL_GENERATOR_H_
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/*! ****************************************************************************
+ *  \brief Generates heights of skip list nodes.
+ *
+ *  Owns a xorshift64* generator, so it does not touch the global rand()
+ *  state and gives the same sequence for the same seed. A whole height is
+ *  drawn from a single random word:
+ *   - for p = 1/2 every bit is a coin, so the height is the number of
+ *     trailing one bits;
+ *   - for any other p the word is compared with precomputed thresholds
+ *     p^(i + 1), the height is the number of thresholds above it.
+ ******************************************************************************/
+class LevelGenerator
+{
+public:
+    // Constants
+
+    /// Seed used when none is given.
+    static const std::uint64_t DEFAULT_SEED = 0x2545F4914F6CDD1DULL;
+
+    /// Maximum number of sparse levels.
+    static const int MAX_LEVELS = 63;
+
+public:
+    /// \brief Initializes the generator.
+    /// \param probability is the probability of each sparse level to appear.
+    /// \param numLevels is the number of sparse levels, up to MAX_LEVELS.
+    LevelGenerator(double probability, int numLevels,
+                   std::uint64_t seed = DEFAULT_SEED);
+
+    /// Restarts the sequence from the given \a seed.
+    void seed(std::uint64_t seed);
+
+    /// Returns a random 64-bit word.
+    std::uint64_t nextWord()
+    {
+        _state ^= _state >> 12;
+        _state ^= _state << 25;
+        _state ^= _state >> 27;
+        return _state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /// Returns the highest level for a new node: -1 with probability
+    /// (1 - p), 0 with probability p(1 - p) and so on up to (numLevels-1).
+    int generate()
+    {
+        std::uint64_t word = nextWord();
+
+        if (_isHalf)
+            return countTrailingZeros(~word | _levelCap) - 1;
+
+        // only the high 53 bits: the thresholds are exact doubles
+        word >>= 11;
+
+        int level = -1;
+        while (level < _numLevels - 1 && word < _thresholds[level + 1])
+            ++level;
+
+        return level;
+    }
+
+protected:
+    /// Number of trailing zero bits of a nonzero \a word.
+    static int countTrailingZeros(std::uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+protected:
+    /// State of the xorshift generator, never zero.
+    std::uint64_t _state;
+
+    /// Number of sparse levels.
+    int _numLevels;
+
+    /// Whether the probability is exactly 1/2.
+    bool _isHalf;
+
+    /// Bit (numLevels): caps the number of trailing ones for p = 1/2.
+    std::uint64_t _levelCap;
+
+    /// _thresholds[i] = p^(i + 1) * 2^53: level i appears if a 53-bit
+    /// random number is less than it.
+    std::uint64_t _thresholds[MAX_LEVELS];
+}; // class LevelGenerator
+
+
+#endif // CYBERPOLICE_LEVEL_GENERATOR_H_
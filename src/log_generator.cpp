@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  log_generator.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "log_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+//==============================================================================
+// class LogGenerator
+//==============================================================================
+
+LogGenerator::Options::Options()
+    : lines(1000000)
+    , users(5000)
+    , hosts(300)
+    , zipf(1.0)
+    , rate(20.0)
+    , disorder(0.0)
+    , maxDelay(5)
+    , userWidth(0)
+    , start(2015, 6, 10)
+    , seed(5489)
+{
+}
+
+//------------------------------------------------------------------------------
+
+LogGenerator::LogGenerator(const Options& options)
+    : _options(options)
+    , _random(options.seed)
+    , _startSeconds(options.start.getSeconds())
+{
+    if (options.users == 0 || options.hosts == 0)
+        throw std::invalid_argument("A log needs at least one user and one host");
+
+    if (!(options.rate > 0) || options.zipf < 0 || options.maxDelay < 1
+            || !(options.disorder >= 0 && options.disorder <= 1))
+        throw std::invalid_argument("Bad log generator options");
+
+    _userNames.reserve(options.users);
+    for (std::uint32_t i = 0; i < options.users; ++i)
+    {
+        std::string name = "user" + std::to_string(i);
+        if (name.size() < static_cast<std::size_t>(options.userWidth))
+            name.insert(0, options.userWidth - name.size(), ' ');
+
+        _userNames.push_back(name);
+    }
+
+    _hostNames.reserve(options.hosts);
+    _hostCdf.reserve(options.hosts);
+    double total = 0;
+    for (std::uint32_t i = 0; i < options.hosts; ++i)
+    {
+        _hostNames.push_back("host" + std::to_string(i) + ".ru");
+
+        total += std::pow(i + 1.0, -options.zipf);
+        _hostCdf.push_back(total);
+    }
+
+    for (std::size_t i = 0; i < _hostCdf.size(); ++i)
+        _hostCdf[i] /= total;
+}
+
+//------------------------------------------------------------------------------
+
+void LogGenerator::generate(const OutputBuffer::Sink& sink)
+{
+    TimeStampFormatter formatter;
+    OutputBuffer buffer(sink);
+
+    for (std::uint64_t i = 0; i < _options.lines; ++i)
+        writeRecord(i, formatter, buffer);
+
+    buffer.flush();
+}
+
+//------------------------------------------------------------------------------
+
+std::string LogGenerator::generateText()
+{
+    std::string text;
+    generate([&text](const char* data, std::size_t size) { text.append(data, size); });
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+
+void LogGenerator::writeRecord(std::uint64_t index, TimeStampFormatter& formatter,
+                               OutputBuffer& out)
+{
+    std::int64_t second = _startSeconds + static_cast<std::int64_t>(index / _options.rate);
+    if (_options.disorder > 0 && nextUnit() < _options.disorder)
+        second -= 1 + nextBelow(static_cast<std::uint32_t>(_options.maxDelay));
+
+    // fields out of range are normalized, minutes do not overflow
+    TimeStamp stamp(1970, 1, 1, 0, static_cast<int>(second / 60), static_cast<int>(second % 60));
+
+    const std::string& user = _userNames[nextBelow(_options.users)];
+    std::size_t host = std::upper_bound(_hostCdf.begin(), _hostCdf.end() - 1, nextUnit())
+                     - _hostCdf.begin();
+    const std::string& hostName = _hostNames[host];
+
+    char buf[TimeStamp::SIZE_MAXSTRTIME];
+    out.write(buf, formatter.format(stamp, buf) - buf);
+    out.put(' ');
+    out.write(user.data(), user.size());
+    out.put(' ');
+    out.write(hostName.data(), hostName.size());
+    out.put('\n');
+}
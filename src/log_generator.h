@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 LogGenerator.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_LOG_GENERATOR_H_
+#define CYBERPOLICE_LOG_GENERATOR_H_
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "output_buffer.h"
+#include "time_stamp.h"
+
+
+/*! ****************************************************************************
+ *  \brief Generates synthetic access logs in the format of the journal.
+ *
+ *  Lines are "timestamp user host". Users are picked uniformly, hosts by
+ *  Zipf's law: the host of rank k is visited in proportion to 1 / k^s.
+ *  Stamps grow at the given rate; a given fraction of records is delayed,
+ *  i.e. written with an earlier stamp, which makes the log out of order.
+ *
+ *  The same options give the same text with the same standard library: the
+ *  generator uses std::mt19937_64, whose sequence is fixed by the standard,
+ *  and no library distributions, but the host popularity comes from
+ *  std::pow(), which need not be correctly rounded, so with another library
+ *  a record whose random number falls right at a boundary of the host
+ *  weights may get the next host. With zipf = 0 the text is the same
+ *  everywhere.
+ ******************************************************************************/
+class LogGenerator
+{
+public:
+    /// Parameters of a log.
+    struct Options
+    {
+        /// Default options: a million records of 5000 users on 300 hosts,
+        /// 20 records a second, in order.
+        Options();
+
+        std::uint64_t lines;        ///< Number of records.
+        std::uint32_t users;        ///< Number of different users.
+        std::uint32_t hosts;        ///< Number of different hosts.
+        double zipf;                ///< Exponent s of the host popularity; 0 is uniform.
+        double rate;                ///< Records per second.
+        double disorder;            ///< Fraction of delayed records, [0..1].
+        int maxDelay;               ///< Largest delay in seconds.
+        int userWidth;              ///< Users are right-aligned to this width.
+        TimeStamp start;            ///< Stamp of the first record.
+        std::uint64_t seed;         ///< Seed of the random generator.
+    };
+
+public:
+    /// Checks the options; throws std::invalid_argument for bad ones.
+    explicit LogGenerator(const Options& options);
+
+    /// Writes the whole log to the \a sink.
+    void generate(const OutputBuffer::Sink& sink);
+
+    /// Returns the whole log as a string; for logs that fit into memory.
+    std::string generateText();
+
+protected:
+    /// Writes the next record to the \a out buffer.
+    void writeRecord(std::uint64_t index, TimeStampFormatter& formatter, OutputBuffer& out);
+
+    /// Returns a random number in [0..n).
+    std::uint32_t nextBelow(std::uint32_t n)
+    {
+        return static_cast<std::uint32_t>(((_random() >> 32) * n) >> 32);
+    }
+
+    /// Returns a random number in [0..1).
+    double nextUnit()
+    {
+        return (_random() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+protected:
+    /// Parameters of the log.
+    Options _options;
+
+    /// Source of random numbers.
+    std::mt19937_64 _random;
+
+    /// Whole seconds of the first stamp since 1970.01.01 00:00:00.
+    std::int64_t _startSeconds;
+
+    /// Names of the users.
+    std::vector<std::string> _userNames;
+
+    /// Names of the hosts, the most popular first.
+    std::vector<std::string> _hostNames;
+
+    /// Cumulative probabilities of the hosts.
+    std::vector<double> _hostCdf;
+}; // class LogGenerator
+
+
+#endif // CYBERPOLICE_LOG_GENERATOR_H_
@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  log_tokenizer.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "log_tokenizer.h"
+
+#include <stdexcept>
+
+// the vector versions need per-function target attributes
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CYBERPOLICE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+//==============================================================================
+// Scalar implementation
+//==============================================================================
+
+/// Checks if \a c is a space in the "C" locale: ' ' or one of '\t'..'\r'.
+static inline bool isSpace(char c)
+{
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+//------------------------------------------------------------------------------
+
+static const char* skipSpacesScalar(const char* pos, const char* end)
+{
+    while (pos != end && isSpace(*pos))
+        ++pos;
+
+    return pos;
+}
+
+//------------------------------------------------------------------------------
+
+static const char* skipWordScalar(const char* pos, const char* end)
+{
+    while (pos != end && !isSpace(*pos))
+        ++pos;
+
+    return pos;
+}
+
+//------------------------------------------------------------------------------
+
+static bool parseStampScalar(const char* p, const char* end, int* fields)
+{
+    // 'd' is a digit, other characters must match exactly
+    static const char FORMAT[] = "dddd.dd.dd dd:dd:dd";
+    const int SIZE = sizeof(FORMAT) - 1;
+
+    if (end - p < SIZE)
+        return false;
+
+    for (int i = 0; i < SIZE; ++i)
+    {
+        if (FORMAT[i] == 'd' ? static_cast<unsigned>(p[i] - '0') > 9
+                             : p[i] != FORMAT[i])
+        {
+            return false;
+        }
+    }
+
+    fields[0] = (p[0] - '0') * 1000 + (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+    fields[1] = (p[5] - '0') * 10 + (p[6] - '0');
+    fields[2] = (p[8] - '0') * 10 + (p[9] - '0');
+    fields[3] = (p[11] - '0') * 10 + (p[12] - '0');
+    fields[4] = (p[14] - '0') * 10 + (p[15] - '0');
+    fields[5] = (p[17] - '0') * 10 + (p[18] - '0');
+
+    return true;
+}
+
+
+#ifdef CYBERPOLICE_X86_SIMD
+
+//==============================================================================
+// SSE4.2 implementation
+//==============================================================================
+
+/// The whitespace characters for PCMPESTRI.
+static const char SPACES[16] = { ' ', '\t', '\n', '\v', '\f', '\r' };
+
+//------------------------------------------------------------------------------
+
+__attribute__((target("sse4.2")))
+static const char* skipSpacesSse42(const char* pos, const char* end)
+{
+    const __m128i spaces = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SPACES));
+
+    for (; end - pos >= 16; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        int index = _mm_cmpestri(spaces, 6, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY);
+        if (index < 16)
+            return pos + index;
+    }
+
+    return skipSpacesScalar(pos, end);
+}
+
+//------------------------------------------------------------------------------
+
+__attribute__((target("sse4.2")))
+static const char* skipWordSse42(const char* pos, const char* end)
+{
+    const __m128i spaces = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SPACES));
+
+    for (; end - pos >= 16; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        int index = _mm_cmpestri(spaces, 6, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY);
+        if (index < 16)
+            return pos + index;
+    }
+
+    return skipWordScalar(pos, end);
+}
+
+//------------------------------------------------------------------------------
+
+__attribute__((target("sse4.2")))
+static bool parseStampSse42(const char* p, const char* end, int* fields)
+{
+    if (end - p < 19)
+        return false;
+
+    // "YYYY.MM.DD HH:MM:SS" is 19 characters: the first load has the year,
+    // the second one, at 3, has all the rest
+    const __m128i zero = _mm_set1_epi8('0');
+    __m128i head = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), zero);
+    __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3));
+    __m128i tail = _mm_sub_epi8(raw, zero);
+
+    // a byte is a digit if it does not change by clamping to 9
+    const __m128i nine = _mm_set1_epi8(9);
+    __m128i headDigits = _mm_cmpeq_epi8(_mm_min_epu8(head, nine), head);
+    __m128i tailDigits = _mm_cmpeq_epi8(_mm_min_epu8(tail, nine), tail);
+
+    // "Y.MM.DD HH:MM:SS": separators must match, the rest must be digits
+    const __m128i separators = _mm_setr_epi8(0, '.', 0, 0, '.', 0, 0, ' ',
+                                             0, 0, ':', 0, 0, ':', 0, 0);
+    const __m128i digitMask = _mm_setr_epi8(-1, 0, -1, -1, 0, -1, -1, 0,
+                                            -1, -1, 0, -1, -1, 0, -1, -1);
+    __m128i tailValid = _mm_blendv_epi8(_mm_cmpeq_epi8(raw, separators), tailDigits, digitMask);
+
+    if ((_mm_movemask_epi8(headDigits) & 0x7) != 0x7 || _mm_movemask_epi8(tailValid) != 0xFFFF)
+        return false;
+
+    // gather the 14 digits in pairs and make numbers of them: pairs of
+    // bytes times (10, 1) give the two-digit numbers
+    const char Z = -128;                // zeroes the byte in PSHUFB
+    __m128i digits = _mm_or_si128(
+            _mm_shuffle_epi8(head, _mm_setr_epi8(0, 1, 2, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z)),
+            _mm_shuffle_epi8(tail, _mm_setr_epi8(Z, Z, Z, 0, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, Z, Z)));
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                            10, 1, 10, 1, 10, 1, 10, 1));
+
+    fields[0] = _mm_extract_epi16(pairs, 0) * 100 + _mm_extract_epi16(pairs, 1);
+    fields[1] = _mm_extract_epi16(pairs, 2);
+    fields[2] = _mm_extract_epi16(pairs, 3);
+    fields[3] = _mm_extract_epi16(pairs, 4);
+    fields[4] = _mm_extract_epi16(pairs, 5);
+    fields[5] = _mm_extract_epi16(pairs, 6);
+
+    return true;
+}
+
+
+//==============================================================================
+// AVX2 implementation
+//==============================================================================
+
+/// Returns a mask of the spaces among 32 characters at \a pos.
+__attribute__((target("avx2")))
+static inline unsigned spaceMaskAvx2(const char* pos)
+{
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+
+    // '\t'..'\r' become 0..4, everything else is above 4
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8('\t'));
+    __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    __m256i isBlank = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
+
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(isControl, isBlank)));
+}
+
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static const char* skipSpacesAvx2(const char* pos, const char* end)
+{
+    for (; end - pos >= 32; pos += 32)
+    {
+        unsigned mask = ~spaceMaskAvx2(pos);
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+    }
+
+    return skipSpacesSse42(pos, end);
+}
+
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static const char* skipWordAvx2(const char* pos, const char* end)
+{
+    for (; end - pos >= 32; pos += 32)
+    {
+        unsigned mask = spaceMaskAvx2(pos);
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+    }
+
+    return skipWordSse42(pos, end);
+}
+
+#endif // CYBERPOLICE_X86_SIMD
+
+
+//==============================================================================
+// class LogTokenizer
+//==============================================================================
+
+const int LogTokenizer::STAMP_FIELDS;
+
+//------------------------------------------------------------------------------
+
+LogTokenizer::State& LogTokenizer::state()
+{
+    // a local static is initialized on first use, also from static
+    // initializers of other translation units
+    static State current = { getBestIsa(), getImpl(getBestIsa()) };
+    return current;
+}
+
+//------------------------------------------------------------------------------
+
+LogTokenizer::Isa LogTokenizer::getBestIsa()
+{
+#ifdef CYBERPOLICE_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return ISA_AVX2;
+
+    if (__builtin_cpu_supports("sse4.2"))
+        return ISA_SSE42;
+#endif
+
+    return ISA_SCALAR;
+}
+
+//------------------------------------------------------------------------------
+
+void LogTokenizer::setIsa(Isa isa)
+{
+    if (isa > getBestIsa())
+        throw std::invalid_argument("The CPU does not support the instruction set");
+
+    State& current = state();
+    current.isa = isa;
+    current.impl = getImpl(isa);
+}
+
+//------------------------------------------------------------------------------
+
+LogTokenizer::Impl LogTokenizer::getImpl(Isa isa)
+{
+    Impl impl;
+    impl.skipSpaces = skipSpacesScalar;
+    impl.skipWord = skipWordScalar;
+    impl.parseStamp = parseStampScalar;
+
+#ifdef CYBERPOLICE_X86_SIMD
+    if (isa == ISA_SSE42)
+    {
+        impl.skipSpaces = skipSpacesSse42;
+        impl.skipWord = skipWordSse42;
+        impl.parseStamp = parseStampSse42;
+    }
+    else if (isa == ISA_AVX2)
+    {
+        // a stamp fits into 16 bytes, so it is parsed the same way
+        impl.skipSpaces = skipSpacesAvx2;
+        impl.skipWord = skipWordAvx2;
+        impl.parseStamp = parseStampSse42;
+    }
+#else
+    (void)isa;
+#endif
+
+    return impl;
+}
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 LogTokenizer.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_LOG_TOKENIZER_H_
+#define CYBERPOLICE_LOG_TOKENIZER_H_
+
+#include <cstddef>
+
+
+/*! ****************************************************************************
+ *  \brief Splits lines of an access log into tokens.
+ *
+ *  Whitespace is the same as for isspace() in the "C" locale.
+ *
+ *  On x86 with GCC or Clang the tokenizer uses AVX2 if the CPU has it,
+ *  otherwise SSE4.2 if it has that, otherwise plain C++. On other targets
+ *  and compilers it always uses plain C++. The choice is made on the first
+ *  call, so the tokenizer also works during static initialization. All
+ *  implementations give the same results and never read past \a end.
+ ******************************************************************************/
+class LogTokenizer
+{
+public:
+    /// Instruction sets the tokenizer can use.
+    enum Isa
+    {
+        ISA_SCALAR,         ///< Plain C++.
+        ISA_SSE42,          ///< 16 characters at a time.
+        ISA_AVX2            ///< 32 characters at a time.
+    };
+
+    /// Number of fields in a stamp: year, month, day, hours, minutes, seconds.
+    static const int STAMP_FIELDS = 6;
+
+public:
+    /// Returns the best instruction set the CPU supports.
+    static Isa getBestIsa();
+
+    /// Returns the instruction set in use.
+    static Isa getIsa() { return state().isa; }
+
+    /// \brief Switches to another instruction set, e.g. to compare them.
+    ///
+    /// Throws std::invalid_argument if the CPU does not support \a isa.
+    /// Must not be called while the tokenizer is in use.
+    static void setIsa(Isa isa);
+
+    /// Returns the first non-space character in [\a pos, \a end).
+    static const char* skipSpaces(const char* pos, const char* end)
+    {
+        return state().impl.skipSpaces(pos, end);
+    }
+
+    /// Returns the first space character in [\a pos, \a end).
+    static const char* skipWord(const char* pos, const char* end)
+    {
+        return state().impl.skipWord(pos, end);
+    }
+
+    /// \brief Reads the fixed part "YYYY.MM.DD HH:MM:SS" of a stamp at
+    /// \a pos into \a fields.
+    ///
+    /// Every field must have all its digits, separators must match.
+    /// \return false if [\a pos, \a end) does not start with such a stamp.
+    static bool parseStamp(const char* pos, const char* end, int fields[STAMP_FIELDS])
+    {
+        return state().impl.parseStamp(pos, end, fields);
+    }
+
+protected:
+    /// Functions of a single instruction set.
+    struct Impl
+    {
+        const char* (*skipSpaces)(const char* pos, const char* end);
+        const char* (*skipWord)(const char* pos, const char* end);
+        bool (*parseStamp)(const char* pos, const char* end, int* fields);
+    };
+
+    /// Instruction set in use and its functions.
+    struct State
+    {
+        Isa isa;
+        Impl impl;
+    };
+
+    /// Returns the functions for \a isa.
+    static Impl getImpl(Isa isa);
+
+    /// Returns the state in use, choosing the best instruction set on first call.
+    static State& state();
+}; // class LogTokenizer
+
+
+#endif // CYBERPOLICE_LOG_TOKENIZER_H_
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  mapped_file.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CYBERPOLICE_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+// class MappedFile
+//==============================================================================
+
+MappedFile::MappedFile(const std::string& fullpath)
+    : _data(nullptr)
+    , _size(0)
+    , _mapped(false)
+{
+#ifdef CYBERPOLICE_HAS_MMAP
+    int fd = open(fullpath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::logic_error("Couldn't open file " + fullpath);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::logic_error("Couldn't open file " + fullpath);
+    }
+
+    // pipes and devices have no size, procfs files report zero: read them
+    if (!S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        readAll(fd, fullpath);
+        close(fd);
+        return;
+    }
+
+    _size = static_cast<std::size_t>(info.st_size);
+
+    void* addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        close(fd);
+        throw std::logic_error("Couldn't map file " + fullpath);
+    }
+
+    // the file is read from the beginning to the end just once
+    madvise(addr, _size, MADV_SEQUENTIAL);
+
+    _data = static_cast<const char*>(addr);
+    _mapped = true;
+
+    // the mapping holds the file by itself
+    close(fd);
+#else
+    std::ifstream fin(fullpath, std::ios::binary);
+    if (!fin)
+        throw std::logic_error("Couldn't open file " + fullpath);
+
+    _buffer.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+#ifdef CYBERPOLICE_HAS_MMAP
+    if (_mapped)
+        munmap(const_cast<char*>(_data), _size);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef CYBERPOLICE_HAS_MMAP
+
+void MappedFile::readAll(int fd, const std::string& fullpath)
+{
+    const std::size_t CHUNK_SIZE = 64 * 1024;
+
+    std::size_t used = 0;
+    for (;;)
+    {
+        _buffer.resize(used + CHUNK_SIZE);
+        ssize_t count = read(fd, _buffer.data() + used, CHUNK_SIZE);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+        {
+            close(fd);
+            throw std::logic_error("Couldn't read file " + fullpath);
+        }
+        if (count == 0)
+            break;
+
+        used += static_cast<std::size_t>(count);
+    }
+
+    _buffer.resize(used);
+    _data = _buffer.data();
+    _size = used;
+}
+
+#endif
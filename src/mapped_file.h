@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 MappedFile.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_MAPPED_FILE_H_
+#define CYBERPOLICE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/*! ****************************************************************************
+ *  \brief Read-only view of a whole file.
+ *
+ *  On POSIX systems the file is mapped into memory, so its pages are read
+ *  by the kernel on demand and never copied into the process. Files that
+ *  cannot be mapped by their size (pipes, devices, procfs) and all files on
+ *  other systems are read into a buffer.
+ ******************************************************************************/
+class MappedFile
+{
+public:
+    /// Opens the file on \a fullpath; throws std::logic_error if it cannot
+    /// be opened or mapped.
+    explicit MappedFile(const std::string& fullpath);
+
+    /// Unmaps the file.
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    /// Contents of the file; not terminated by zero.
+    const char* data() const { return _data; }
+
+    /// Size of the file in bytes.
+    std::size_t size() const { return _size; }
+
+protected:
+    /// Reads the open descriptor \a fd up to its end into _buffer; closes it
+    /// and throws std::logic_error on errors.
+    void readAll(int fd, const std::string& fullpath);
+
+protected:
+    /// First byte of the contents.
+    const char* _data;
+
+    /// Size of the contents.
+    std::size_t _size;
+
+    /// Whether _data is a mapping to be released with munmap().
+    bool _mapped;
+
+    /// Contents of a file that is not mapped.
+    std::vector<char> _buffer;
+}; // class MappedFile
+
+
+#endif // CYBERPOLICE_MAPPED_FILE_H_
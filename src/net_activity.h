@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// \file
 /// \brief      Contains interfaces for the following classes:
-///                 NetActivity.
+///                 NetActivity, NetActivityRecord.
 ///
 /// \author     Leonid W. Dworzanski <leo@mathtech.ru> © 2014–2016.
 /// \author     Sergey A. Shershakov <sshershakov@hse.ru> © 2015–2018.
@@ -22,6 +22,8 @@
 #include <string>
 #include <iostream>
 
+#include "string_interner.h"
+
 /*! ****************************************************************************
  *  The NetActivity struct
  ******************************************************************************/
@@ -34,6 +36,21 @@ struct NetActivity
     std::string host;
 };
 
+/*! ****************************************************************************
+ *  \brief Compact form of NetActivity kept by a journal.
+ *
+ *  Holds ids of the user and the host in the dictionaries of the journal
+ *  instead of the strings themselves.
+ ******************************************************************************/
+struct NetActivityRecord
+{
+    /// Id of the name of the user.
+    StringInterner::Id user;
+
+    /// Id of the URL of the host.
+    StringInterner::Id host;
+};
+
 /// Operator is declared in the global scope!
 std::ostream& operator<< (std::ostream& out, const NetActivity& na);
 
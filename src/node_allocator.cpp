@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  node_allocator.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "node_allocator.h"
+
+#include <new>
+
+//==============================================================================
+// class HeapNodeAllocator
+//==============================================================================
+
+void* HeapNodeAllocator::allocate(std::size_t size)
+{
+    return ::operator new(size);
+}
+
+//------------------------------------------------------------------------------
+
+void HeapNodeAllocator::deallocate(void* ptr, std::size_t /*size*/)
+{
+    ::operator delete(ptr);
+}
+
+
+//==============================================================================
+// class ArenaNodeAllocator
+//==============================================================================
+
+const std::size_t ArenaNodeAllocator::MIN_BLOCK_SIZE;
+const std::size_t ArenaNodeAllocator::MAX_BLOCK_SIZE;
+const std::size_t ArenaNodeAllocator::ALIGNMENT;
+
+//------------------------------------------------------------------------------
+
+ArenaNodeAllocator::ArenaNodeAllocator()
+    : _cur(nullptr)
+    , _end(nullptr)
+    , _nextBlockSize(MIN_BLOCK_SIZE)
+{
+}
+
+//------------------------------------------------------------------------------
+
+ArenaNodeAllocator::~ArenaNodeAllocator()
+{
+    for (size_t i = 0; i < _blocks.size(); ++i)
+        ::operator delete(_blocks[i]);
+}
+
+//------------------------------------------------------------------------------
+
+void* ArenaNodeAllocator::allocate(std::size_t size)
+{
+    size = alignSize(size);
+    if (size > static_cast<std::size_t>(_end - _cur))
+        grow(size);
+
+    void* ptr = _cur;
+    _cur += size;
+
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+
+void ArenaNodeAllocator::deallocate(void* /*ptr*/, std::size_t /*size*/)
+{
+    // memory is released by the destructor
+}
+
+//------------------------------------------------------------------------------
+
+void ArenaNodeAllocator::grow(std::size_t size)
+{
+    std::size_t blockSize = _nextBlockSize;
+    while (blockSize < size)
+        blockSize *= 2;
+
+    // make room for the pointer before allocating, so push_back can't throw
+    // after the block is taken
+    _blocks.reserve(_blocks.size() + 1);
+    char* block = static_cast<char*>(::operator new(blockSize));
+    _blocks.push_back(block);
+
+    _cur = block;
+    _end = block + blockSize;
+
+    if (_nextBlockSize < MAX_BLOCK_SIZE)
+        _nextBlockSize *= 2;
+}
+
+
+//==============================================================================
+// class SlabNodeAllocator
+//==============================================================================
+
+void* SlabNodeAllocator::allocate(std::size_t size)
+{
+    FreeList& list = getFreeList(size);
+    if (list.head)
+    {
+        FreeNode* node = list.head;
+        list.head = node->next;
+        return node;
+    }
+
+    return _arena.allocate(list.size);
+}
+
+//------------------------------------------------------------------------------
+
+void SlabNodeAllocator::deallocate(void* ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+
+    FreeList& list = getFreeList(size);
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next = list.head;
+    list.head = node;
+}
+
+//------------------------------------------------------------------------------
+
+SlabNodeAllocator::FreeList& SlabNodeAllocator::getFreeList(std::size_t size)
+{
+    // a freed node must be able to hold a link
+    if (size < sizeof(FreeNode))
+        size = sizeof(FreeNode);
+    size = (size + ArenaNodeAllocator::ALIGNMENT - 1)
+            & ~(ArenaNodeAllocator::ALIGNMENT - 1);
+
+    for (size_t i = 0; i < _freeLists.size(); ++i)
+        if (_freeLists[i].size == size)
+            return _freeLists[i];
+
+    FreeList list = { size, nullptr };
+    _freeLists.push_back(list);
+
+    return _freeLists.back();
+}
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 HeapNodeAllocator, ArenaNodeAllocator, SlabNodeAllocator.
+///
+/// Node allocators are policies for OrderedList and SkipList. Each of them
+/// provides two methods:
+///     void* allocate(std::size_t size);
+///     void deallocate(void* ptr, std::size_t size);
+/// where \a size of deallocate() is the same as the one passed to allocate().
+/// A list owns its allocator, so all nodes die together with the list.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_NODE_ALLOCATOR_H_
+#define CYBERPOLICE_NODE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <vector>
+
+
+/*! ****************************************************************************
+ *  \brief Default allocator: every node is a separate heap object.
+ *
+ *  Behaves exactly like plain new/delete.
+ ******************************************************************************/
+class HeapNodeAllocator
+{
+public:
+    /// Allocates \a size bytes with ::operator new.
+    void* allocate(std::size_t size);
+
+    /// Returns \a ptr to the heap.
+    void deallocate(void* ptr, std::size_t size);
+}; // class HeapNodeAllocator
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Bump-pointer arena.
+ *
+ *  Nodes are cut one after another from large blocks, each next block is
+ *  twice as large as the previous one (up to MAX_BLOCK_SIZE). deallocate()
+ *  does nothing: the memory is released only when the arena dies, so use it
+ *  for lists that grow and are destroyed as a whole (like a journal).
+ ******************************************************************************/
+class ArenaNodeAllocator
+{
+public:
+    // Constants
+
+    /// Size of the very first block.
+    static const std::size_t MIN_BLOCK_SIZE = 4 * 1024;
+
+    /// Blocks do not grow beyond this size.
+    static const std::size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    /// Every allocation is aligned to this boundary.
+    static const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+public:
+    /// Default constructor. No memory is taken until the first allocation.
+    ArenaNodeAllocator();
+
+    /// Releases all the blocks at once.
+    ~ArenaNodeAllocator();
+
+    // an arena owns its blocks, so it must not be copied
+    ArenaNodeAllocator(const ArenaNodeAllocator&) = delete;
+    ArenaNodeAllocator& operator=(const ArenaNodeAllocator&) = delete;
+
+    /// Cuts \a size bytes from the current block.
+    void* allocate(std::size_t size);
+
+    /// Does nothing, see the class description.
+    void deallocate(void* ptr, std::size_t size);
+
+    /// Returns the number of blocks taken from the heap.
+    std::size_t getBlockCount() const { return _blocks.size(); }
+
+protected:
+    /// Rounds \a size up to ALIGNMENT.
+    static std::size_t alignSize(std::size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /// Takes a new block that is able to hold at least \a size bytes.
+    void grow(std::size_t size);
+
+protected:
+    /// All the blocks taken from the heap.
+    std::vector<char*> _blocks;
+
+    /// Free space of the current block is [_cur, _end).
+    char* _cur;
+    char* _end;
+
+    /// Size of the next block to be taken.
+    std::size_t _nextBlockSize;
+}; // class ArenaNodeAllocator
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Slab allocator with free lists.
+ *
+ *  Takes memory from an arena, but deallocated nodes are kept in a free list
+ *  (one list per node size) and reused by the next allocations of the same
+ *  size. Suits lists with many removals.
+ ******************************************************************************/
+class SlabNodeAllocator
+{
+public:
+    /// Takes a node from the free list of \a size or cuts a new one.
+    void* allocate(std::size_t size);
+
+    /// Puts \a ptr to the free list of \a size.
+    void deallocate(void* ptr, std::size_t size);
+
+protected:
+    /// A freed node is reused as a link of the free list.
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    /// Head of a free list with nodes of the given size.
+    struct FreeList
+    {
+        std::size_t size;
+        FreeNode* head;
+    };
+
+    /// Returns the free list for nodes of \a size, creates one if needed.
+    FreeList& getFreeList(std::size_t size);
+
+protected:
+    /// Source of fresh memory.
+    ArenaNodeAllocator _arena;
+
+    /// Node sizes are few, so a plain vector with a linear search is enough.
+    std::vector<FreeList> _freeLists;
+}; // class SlabNodeAllocator
+
+
+#endif // CYBERPOLICE_NODE_ALLOCATOR_H_
@@ -18,6 +18,13 @@
 #ifndef CYBERPOLICE_ORDERED_LIST_H_
 #define CYBERPOLICE_ORDERED_LIST_H_
 
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "node_allocator.h"
+
 /*!****************************************************************************
  *  Abstract list node with a value.
  *****************************************************************************/
@@ -28,7 +35,11 @@ struct NodeAbstract
     NodeAbstract () : next(nullptr) { }
 
     /// Init with value.
-    NodeAbstract (const Value& value) : next(nullptr), value(value) { }
+    NodeAbstract (const Value& value) : value(value), next(nullptr) { }
+
+    /// Returns the number of bytes the node occupies. Nodes of variable size
+    /// hide this method with their own one.
+    std::size_t allocSize() const { return sizeof(Next); }
 
     //----<Fields>-----
     Value value;            ///< Stores value;
@@ -101,24 +112,204 @@ struct NodeWithKey
 //=============================================================================
 
 
+/*!****************************************************************************
+ *  \brief Forward iterator over the nodes of a list.
+ *
+ *  Dereferences to a node, so the key and the value are it->key and
+ *  it->value. The sentinel serves as the end of a list.
+ *  \a Ref and \a Ptr are (Node&, Node*) or (const Node&, const Node*).
+ *****************************************************************************/
+template <class Node, class Ref, class Ptr>
+class OrderedListIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Node value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+
+public:
+    /// Default constructor: a singular iterator.
+    OrderedListIterator() : _node(nullptr) { }
+
+    /// Init with a node.
+    explicit OrderedListIterator(Node* node) : _node(node) { }
+
+    /// Converts iterator to const_iterator, but not the other way around.
+    template <class ORef, class OPtr>
+    OrderedListIterator(const OrderedListIterator<Node, ORef, OPtr>& other,
+                        typename std::enable_if<std::is_convertible<OPtr, Ptr>::value>::type* = 0)
+        : _node(other.getNode())
+    { }
+
+    Ref operator*() const { return *_node; }
+    Ptr operator->() const { return _node; }
+
+    OrderedListIterator& operator++()
+    {
+        _node = _node->next;
+        return *this;
+    }
+
+    OrderedListIterator operator++(int)
+    {
+        OrderedListIterator tmp = *this;
+        _node = _node->next;
+        return tmp;
+    }
+
+    bool operator==(const OrderedListIterator& another) const { return _node == another._node; }
+    bool operator!=(const OrderedListIterator& another) const { return _node != another._node; }
+
+    /// Returns the node the iterator points to.
+    Node* getNode() const { return _node; }
+
+protected:
+    Node* _node;
+};
+
+//=============================================================================
+
+
+/*!****************************************************************************
+ *  \brief Statically dispatched core of an ordered list.
+ *
+ *  Owns the nodes and implements the list with no virtual methods. Searches
+ *  behind the iterator methods are called on \a Derived (CRTP), so the most
+ *  derived implementation is used with no vtable, unless \a Derived makes
+ *  them virtual itself (as OrderedList does).
+ *
+ *  All nodes are taken from and returned to the \a Alloc policy
+ *  (see node_allocator.h). The default one is plain new/delete.
+ *****************************************************************************/
+template <class Derived, class Value, class Key, class Node, class Alloc>
+class OrderedListBase
+{
+public:
+	typedef NodeWithKey<Value,Key> TypeNode;
+
+    /// Iterators over the nodes of the list in the order of keys.
+    typedef OrderedListIterator<Node, Node&, Node*> iterator;
+    typedef OrderedListIterator<Node, const Node&, const Node*> const_iterator;
+
+    /// Inserts a new node with the given (value == val) and (key == tkey).
+    void insert(const Value& val, const Key& tkey);
+
+    /// Removes node just after \a nodeBefore.
+    void removeNext(Node* nodeBefore);
+
+    /// Finds the last node in the list, which key is strictly less
+    /// than \a key argument.
+    Node* findLastLessThan(const Key& key) const;
+
+    /// Finds the first node in the list, which key is equal to
+    /// \a key argument.
+    Node* findFirst(const Key& key) const;
+
+    /// Finds the last node in the list, which key is less than or equal
+    /// to \a key argument.
+    Node* findLastNotGreaterThan(const Key& key) const;
+
+    /// Returns the sentinel node.
+    Node* getPreHead() const { return _preHead; }
+
+    //----<Iterators>-----
+
+    iterator begin() { return iterator(_preHead->next); }
+    const_iterator begin() const { return const_iterator(_preHead->next); }
+
+    iterator end() { return iterator(_preHead); }
+    const_iterator end() const { return const_iterator(_preHead); }
+
+    /// Returns the first node with a key not less than \a key.
+    iterator lower_bound(const Key& key)
+    {
+        return iterator(derived().findLastLessThan(key)->next);
+    }
+
+    const_iterator lower_bound(const Key& key) const
+    {
+        return const_iterator(derived().findLastLessThan(key)->next);
+    }
+
+    /// Returns the first node with a key greater than \a key.
+    iterator upper_bound(const Key& key)
+    {
+        return iterator(derived().findLastNotGreaterThan(key)->next);
+    }
+
+    const_iterator upper_bound(const Key& key) const
+    {
+        return const_iterator(derived().findLastNotGreaterThan(key)->next);
+    }
+
+    /// Returns the range of nodes with keys equal to \a key.
+    std::pair<iterator, iterator> equal_range(const Key& key)
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+protected:
+    /// Default constructor. Only derived lists are created.
+    OrderedListBase();
+
+    /// Deletes all the nodes including the sentinel.
+    ~OrderedListBase();
+
+    // a list owns its nodes, so it must not be copied
+    OrderedListBase(const OrderedListBase&) = delete;
+    OrderedListBase& operator=(const OrderedListBase&) = delete;
+
+    /// Returns this object as the most derived list.
+    Derived& derived() { return static_cast<Derived&>(*this); }
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    /// Creates a default-initialized node using the allocator.
+    Node* newNode();
+
+    /// Creates a node with the given key and value using the allocator.
+    Node* newNode(const Key& key, const Value& val);
+
+    /// Destroys the \a node and returns its memory to the allocator.
+    void deleteNode(Node* node);
+
+protected:
+    /// Node allocator. Declared before \a _preHead, 'cause the sentinel is
+    /// taken from it.
+    Alloc _alloc;
+
+    // Sentinel element - placed before first and after last elements
+    Node* _preHead;
+};
+
+//=============================================================================
+
+
 /*!****************************************************************************
  *  \brief Represents an ordered list.
  *  Due to virtual nature of major methods, we do not declare them as inline ones.
+ *
+ *  All the work is done by OrderedListBase, this class makes its major
+ *  methods virtual for the derived lists (see SkipList).
  *****************************************************************************/
-template <class Value, class Key, class Node = NodeWithKey<Value,Key> >
+template <class Value, class Key, class Node = NodeWithKey<Value,Key>,
+          class Alloc = HeapNodeAllocator>
 class OrderedList
+        : public OrderedListBase<OrderedList<Value, Key, Node, Alloc>, Value, Key, Node, Alloc>
 {
 public:
-	typedef NodeWithKey<Value,Key> TypeNode;
-
-    /// Default constructor.
-    OrderedList();
+    /// Alias for the base class.
+    typedef OrderedListBase<OrderedList<Value, Key, Node, Alloc>, Value, Key, Node, Alloc> Base;
 
     /// Virtual destructor.
     virtual ~OrderedList();
 
-    // TODO: деструктор!
-
     /// Inserts a new node with the given (value == val) and (key == tkey).
     virtual void insert(const Value& val, const Key& tkey);
 
@@ -133,12 +324,28 @@ public:
     /// \a key argument.
     virtual Node* findFirst(const Key& key) const;
 
+    /// Finds the last node in the list, which key is less than or equal
+    /// to \a key argument.
+    virtual Node* findLastNotGreaterThan(const Key& key) const;
+
 
     virtual Node* getPreHead() const;
+};
 
-protected:
-    // Sentinel element - placed before first and after last elements
-    Node* _preHead;
+//=============================================================================
+
+
+/*!****************************************************************************
+ *  \brief Ordered list with no virtual methods.
+ *
+ *  Has the same semantics as OrderedList, but every call is statically bound
+ *  and can be inlined.
+ *****************************************************************************/
+template <class Value, class Key, class Node = NodeWithKey<Value,Key>,
+          class Alloc = HeapNodeAllocator>
+class StaticOrderedList
+        : public OrderedListBase<StaticOrderedList<Value, Key, Node, Alloc>, Value, Key, Node, Alloc>
+{
 };
 
 
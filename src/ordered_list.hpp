@@ -11,48 +11,88 @@
 
 // !!! DO NOT include ordered_list.h here, 'cause it leads to circular refs. !!!
 
+#include <new>
+
 
 //=============================================================================
-// class NodeSkipList
+// class OrderedListBase
 //=============================================================================
 
 
-template <class Value, class Key, class Node>
-OrderedList<Value, Key, Node>::OrderedList()
+template <class Derived, class Value, class Key, class Node, class Alloc>
+OrderedListBase<Derived, Value, Key, Node, Alloc>::OrderedListBase()
 {
-    _preHead = new Node;
+    _preHead = newNode();
     _preHead->next = _preHead;
 }
 
 //-----------------------------------------------------------------------------
 
+template <class Derived, class Value, class Key, class Node, class Alloc>
+OrderedListBase<Derived, Value, Key, Node, Alloc>::~OrderedListBase()
+{
+    Node* run = _preHead->next;
+    while (run != _preHead)
+    {
+        Node* tmp = run;
+        run = run->next;
+        deleteNode(tmp);
+    }
 
-    // TODO: !!! Implement destructor correctly !!!
+    deleteNode(_preHead);
+}
 
 //-----------------------------------------------------------------------------
 
+template <class Derived, class Value, class Key, class Node, class Alloc>
+Node* OrderedListBase<Derived, Value, Key, Node, Alloc>::newNode()
+{
+    void* mem = _alloc.allocate(sizeof(Node));
+    return new (mem) Node;
+}
 
-template <class Value, class Key, class Node >
-void OrderedList<Value,Key,Node>::insert(const Value& val, const Key& tkey)
+//-----------------------------------------------------------------------------
+
+template <class Derived, class Value, class Key, class Node, class Alloc>
+Node* OrderedListBase<Derived, Value, Key, Node, Alloc>::newNode(const Key& key, const Value& val)
+{
+    void* mem = _alloc.allocate(sizeof(Node));
+    return new (mem) Node(key, val);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class Derived, class Value, class Key, class Node, class Alloc>
+void OrderedListBase<Derived, Value, Key, Node, Alloc>::deleteNode(Node* node)
 {
-    // ищем "последний" элемент в цепочке
+    std::size_t size = node->allocSize();
+    node->~Node();
+    _alloc.deallocate(node, size);
+}
+
+//-----------------------------------------------------------------------------
+
+
+template <class Derived, class Value, class Key, class Node, class Alloc>
+void OrderedListBase<Derived, Value, Key, Node, Alloc>::insert(const Value& val, const Key& tkey)
+{
+    // ищем последний элемент с ключом, не большим tkey: так равные ключи
+    // остаются в порядке вставки
     Node* run = _preHead;
-    while (run->next != _preHead)
+    while (run->next != _preHead && !(tkey < run->next->key))
         run = run->next;
 
 
-    Node* tmp = new Node;
+    Node* tmp = newNode(tkey, val);
     tmp->next = run->next;
-    tmp->key = tkey;
-    tmp->value = val;
 
     run->next = tmp;
 }
 
 //-----------------------------------------------------------------------------
 
-template <class Value, class Key, class Node >
-void OrderedList<Value,Key,Node>::removeNext(Node* nodeBefore)
+template <class Derived, class Value, class Key, class Node, class Alloc>
+void OrderedListBase<Derived, Value, Key, Node, Alloc>::removeNext(Node* nodeBefore)
 {
     if (nodeBefore == nullptr
         || nodeBefore->next == nullptr
@@ -63,14 +103,14 @@ void OrderedList<Value,Key,Node>::removeNext(Node* nodeBefore)
 
     Node* tmp = nodeBefore->next;
     nodeBefore->next = tmp->next;
-    delete tmp;
+    deleteNode(tmp);
 }
 
 //-----------------------------------------------------------------------------
 
 
-template <class Value, class Key, class Node >
-Node* OrderedList<Value,Key,Node>::findLastLessThan(const Key& key) const
+template <class Derived, class Value, class Key, class Node, class Alloc>
+Node* OrderedListBase<Derived, Value, Key, Node, Alloc>::findLastLessThan(const Key& key) const
 {
     Node* run = _preHead;
     while(run->next != _preHead && run->next->key < key)
@@ -81,8 +121,8 @@ Node* OrderedList<Value,Key,Node>::findLastLessThan(const Key& key) const
 
 //-----------------------------------------------------------------------------
 
-template <class Value, class Key, class Node >
-Node* OrderedList<Value,Key,Node>::findFirst(const Key& key) const
+template <class Derived, class Value, class Key, class Node, class Alloc>
+Node* OrderedListBase<Derived, Value, Key, Node, Alloc>::findFirst(const Key& key) const
 {
     Node* run = _preHead;
     while (run->next != _preHead)
@@ -97,12 +137,75 @@ Node* OrderedList<Value,Key,Node>::findFirst(const Key& key) const
 
 //-----------------------------------------------------------------------------
 
-// Returns the sentinel node
-template <class Value, class Key, class Node>
-Node* OrderedList<Value, Key, Node>::getPreHead() const
+template <class Derived, class Value, class Key, class Node, class Alloc>
+Node* OrderedListBase<Derived, Value, Key, Node, Alloc>::findLastNotGreaterThan(const Key& key) const
+{
+    Node* run = _preHead;
+    while(run->next != _preHead && !(key < run->next->key))
+        run = run->next;
+
+    return run;
+}
+
+//-----------------------------------------------------------------------------
+
+
+//=============================================================================
+// class OrderedList
+//=============================================================================
+
+template <class Value, class Key, class Node, class Alloc>
+OrderedList<Value, Key, Node, Alloc>::~OrderedList()
 {
-    return _preHead;
 }
 
 //-----------------------------------------------------------------------------
 
+template <class Value, class Key, class Node, class Alloc>
+void OrderedList<Value, Key, Node, Alloc>::insert(const Value& val, const Key& tkey)
+{
+    Base::insert(val, tkey);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class Value, class Key, class Node, class Alloc>
+void OrderedList<Value, Key, Node, Alloc>::removeNext(Node* nodeBefore)
+{
+    Base::removeNext(nodeBefore);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class Value, class Key, class Node, class Alloc>
+Node* OrderedList<Value, Key, Node, Alloc>::findLastLessThan(const Key& key) const
+{
+    return Base::findLastLessThan(key);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class Value, class Key, class Node, class Alloc>
+Node* OrderedList<Value, Key, Node, Alloc>::findFirst(const Key& key) const
+{
+    return Base::findFirst(key);
+}
+
+//-----------------------------------------------------------------------------
+
+template <class Value, class Key, class Node, class Alloc>
+Node* OrderedList<Value, Key, Node, Alloc>::findLastNotGreaterThan(const Key& key) const
+{
+    return Base::findLastNotGreaterThan(key);
+}
+
+//-----------------------------------------------------------------------------
+
+// Returns the sentinel node
+template <class Value, class Key, class Node, class Alloc>
+Node* OrderedList<Value, Key, Node, Alloc>::getPreHead() const
+{
+    return Base::getPreHead();
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  output_buffer.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "output_buffer.h"
+
+#include <algorithm>
+
+//==============================================================================
+// class OutputBuffer
+//==============================================================================
+
+const std::size_t OutputBuffer::DEFAULT_CAPACITY;
+
+//------------------------------------------------------------------------------
+
+OutputBuffer::OutputBuffer(const Sink& sink, std::size_t capacity)
+    : _sink(sink)
+    , _data(capacity > 0 ? capacity : 1)
+    , _size(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+OutputBuffer::Sink OutputBuffer::streamSink(std::ostream& out)
+{
+    std::ostream* stream = &out;
+    return [stream](const char* data, std::size_t size)
+    {
+        stream->write(data, static_cast<std::streamsize>(size));
+    };
+}
+
+//------------------------------------------------------------------------------
+
+void OutputBuffer::flush()
+{
+    if (_size == 0)
+        return;
+
+    _sink(_data.data(), _size);
+    _size = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void OutputBuffer::writeLarge(const char* data, std::size_t size)
+{
+    flush();
+
+    // a piece larger than the buffer goes straight to the sink
+    if (size >= _data.size())
+    {
+        _sink(data, size);
+        return;
+    }
+
+    std::copy(data, data + size, _data.begin());
+    _size = size;
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 OutputBuffer.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_OUTPUT_BUFFER_H_
+#define CYBERPOLICE_OUTPUT_BUFFER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+
+/*! ****************************************************************************
+ *  \brief Collects output text in a contiguous buffer and passes it to a
+ *  sink in large chunks.
+ *
+ *  Nothing is flushed on line ends: the sink gets a chunk only when the
+ *  buffer is full and on flush().
+ ******************************************************************************/
+class OutputBuffer
+{
+public:
+    // Constants
+
+    /// Default size of the buffer.
+    static const std::size_t DEFAULT_CAPACITY = 64 * 1024;
+
+public:
+    /// Receives a chunk of the text.
+    typedef std::function<void (const char* data, std::size_t size)> Sink;
+
+public:
+    /// Creates a buffer of \a capacity bytes passing text to the \a sink.
+    explicit OutputBuffer(const Sink& sink, std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// Returns a sink writing to the \a out stream with no flushing.
+    static Sink streamSink(std::ostream& out);
+
+    /// Appends \a size bytes at \a data.
+    void write(const char* data, std::size_t size)
+    {
+        if (size > _data.size() - _size)
+        {
+            writeLarge(data, size);
+            return;
+        }
+
+        std::copy(data, data + size, _data.begin() + _size);
+        _size += size;
+    }
+
+    /// Appends a single character.
+    void put(char c)
+    {
+        if (_size == _data.size())
+            flush();
+
+        _data[_size++] = c;
+    }
+
+    /// Passes the collected text to the sink.
+    void flush();
+
+protected:
+    /// Appends a piece that does not fit into the rest of the buffer.
+    void writeLarge(const char* data, std::size_t size);
+
+protected:
+    /// Receiver of the text.
+    Sink _sink;
+
+    /// Buffer; its size is the capacity.
+    std::vector<char> _data;
+
+    /// Number of bytes collected.
+    std::size_t _size;
+}; // class OutputBuffer
+
+
+#endif // CYBERPOLICE_OUTPUT_BUFFER_H_
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  perf_counters.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "perf_counters.h"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+// class PerfCounters
+//==============================================================================
+
+PerfCounters::PerfCounters()
+{
+    for (int i = 0; i < NUM_EVENTS; ++i)
+    {
+        _fds[i] = -1;
+        _values[i] = 0;
+    }
+
+#ifdef __linux__
+    static const std::uint32_t TYPES[NUM_EVENTS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+    static const std::uint64_t CONFIGS[NUM_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+
+    for (int i = 0; i < NUM_EVENTS; ++i)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = TYPES[i];
+        attr.config = CONFIGS[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // threads started later get their own counters, which are added to
+        // these ones when the threads exit
+        attr.inherit = 1;
+
+        // this thread, any CPU, no group
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        _fds[i] = fd >= 0 ? static_cast<int>(fd) : -1;
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int i = 0; i < NUM_EVENTS; ++i)
+        if (_fds[i] >= 0)
+            close(_fds[i]);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+const char* PerfCounters::getName(Event event)
+{
+    static const char* const NAMES[NUM_EVENTS] =
+        { "cycles", "instructions", "cache_misses", "branch_misses", "l1d_read_misses" };
+
+    return NAMES[event];
+}
+
+//------------------------------------------------------------------------------
+
+bool PerfCounters::isAnyAvailable() const
+{
+    for (int i = 0; i < NUM_EVENTS; ++i)
+        if (_fds[i] >= 0)
+            return true;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+    for (int i = 0; i < NUM_EVENTS; ++i)
+        if (_fds[i] >= 0)
+        {
+            ioctl(_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+    for (int i = 0; i < NUM_EVENTS; ++i)
+        if (_fds[i] >= 0)
+            ioctl(_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    for (int i = 0; i < NUM_EVENTS; ++i)
+    {
+        _values[i] = 0;
+        if (_fds[i] < 0)
+            continue;
+
+        // value, time enabled, time running
+        std::uint64_t data[3];
+        if (read(_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+            continue;
+
+        if (data[2] == 0)
+            continue;
+
+        _values[i] = data[2] < data[1]
+                   ? static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                   : data[0];
+    }
+#endif
+}
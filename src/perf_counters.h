@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 PerfCounters.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_PERF_COUNTERS_H_
+#define CYBERPOLICE_PERF_COUNTERS_H_
+
+#include <cstdint>
+
+
+/*! ****************************************************************************
+ *  \brief Hardware performance counters of the calling thread and of the
+ *  threads it starts after the counters are opened.
+ *
+ *  A started thread is counted only once it has exited, so multi-threaded
+ *  code must join its threads before stop().
+ *
+ *  On Linux the counters are opened with perf_event_open(2) and count user
+ *  space only. A counter the kernel refuses (no PMU in a VM, a strict
+ *  perf_event_paranoid, another OS) is just not available; the object
+ *  never throws.
+ *
+ *  If the kernel multiplexes the counters, the values are scaled by the
+ *  share of the time each counter was running.
+ ******************************************************************************/
+class PerfCounters
+{
+public:
+    /// Counted events.
+    enum Event
+    {
+        EV_CYCLES,
+        EV_INSTRUCTIONS,
+        EV_CACHE_MISSES,            ///< Last level cache misses.
+        EV_BRANCH_MISSES,
+        EV_L1D_READ_MISSES,
+        NUM_EVENTS
+    };
+
+public:
+    /// Opens the counters.
+    PerfCounters();
+
+    /// Closes the counters.
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator= (const PerfCounters&) = delete;
+
+    /// Returns the name of the event, e.g. "cache_misses".
+    static const char* getName(Event event);
+
+    /// Checks if the \a event is counted.
+    bool isAvailable(Event event) const { return _fds[event] >= 0; }
+
+    /// Checks if any event is counted.
+    bool isAnyAvailable() const;
+
+    /// Resets and starts the counters.
+    void start();
+
+    /// Stops the counters and reads their values.
+    void stop();
+
+    /// Returns the value of the \a event between the last start() and
+    /// stop(), 0 if it is not available.
+    std::uint64_t get(Event event) const { return _values[event]; }
+
+protected:
+    /// Descriptors of the counters, -1 for not available ones.
+    int _fds[NUM_EVENTS];
+
+    /// Values read by the last stop().
+    std::uint64_t _values[NUM_EVENTS];
+}; // class PerfCounters
+
+
+#endif // CYBERPOLICE_PERF_COUNTERS_H_
@@ -1,7 +1,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// \file
 /// \brief      Contains interfaces for the following classes:
-///                 NodeSkipListAbstract, NodeSkipList, SkipList.
+///                 PlainTower, InlineKeyTower, SkipListLink,
+///                 SkipListTowerKeys, NodeSkipListAbstract, NodeSkipList, SkipListBase, SkipList,
+///                 StaticSkipList.
 ///
 /// \author     Leonid W. Dworzanski <leo@mathtech.ru> © 2014–2016.
 /// \author     Sergey A. Shershakov <sshershakov@hse.ru> © 2015–2018.
@@ -19,37 +21,248 @@
 #ifndef CYBERPOLICE_SKIP_LIST_H_
 #define CYBERPOLICE_SKIP_LIST_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "key_prefix.h"
+#include "level_generator.h"
 #include "ordered_list.h"
+#include "skip_list_stats.h"
+
+
+/// Layout of the sparse levels with pointers only: a search reads the key of
+/// every node it looks at (the default).
+struct PlainTower {};
+
+/// \brief Layout of the sparse levels where each link also keeps the
+/// KeyPrefix of the key it leads to.
+///
+/// A search decides whether to move right by the prefix stored in the
+/// current node and reads the next node only to follow the link, or if the
+/// prefixes are equal and not exact. Costs 8 bytes per sparse level of a
+/// node.
+struct InlineKeyTower {};
+
+/// \brief Enables the range constructors of the lists for input iterators
+/// only, so that a call like SkipList<int, int, 5>(1, 42) takes the seeded
+/// constructor.
+template <class InputIterator>
+using EnableIfInputIterator = typename std::enable_if<std::is_convertible<
+    typename std::iterator_traits<InputIterator>::iterator_category,
+    std::input_iterator_tag>::value>::type;
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief A link of a sparse level of a skip list node.
+ ******************************************************************************/
+template <class Next, class Layout = PlainTower>
+struct SkipListLink
+{
+    /// Next node on the level.
+    Next* next;
+
+    /// \brief Width of the link: the number of dense steps from the node to
+    /// \a next.
+    ///
+    /// A link to the sentinel is as long as if the sentinel stood right
+    /// after the last node.
+    std::size_t span;
+};
+
+//------------------------------------------------------------------------------
+
+/// A link of InlineKeyTower.
+template <class Next>
+struct SkipListLink<Next, InlineKeyTower>
+{
+    /// Next node on the level.
+    Next* next;
+
+    /// KeyPrefix of the key of \a next, read instead of the node.
+    std::uint64_t key;
+
+    /// Width of the link, see SkipListLink.
+    std::size_t span;
+};
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Keys of the successors in the links of the \a Layout.
+ *
+ *  With PlainTower there are none: searches compare the keys themselves.
+ ******************************************************************************/
+template <class Key, class Layout>
+struct SkipListTowerKeys
+{
+    /// Nothing is known about a key ahead of the search.
+    struct Prefix {};
+
+    /// Whether equal prefixes mean equal keys.
+    static const bool exactPrefix = false;
+
+    /// Returns the prefix of the searched \a key.
+    static Prefix makePrefix(const Key&) { return Prefix(); }
+
+    /// Compares the key after the \a link with the \a prefix: -1 or 1 if
+    /// it is less or greater, 0 if the keys must be compared.
+    template <class Link>
+    static int compare(const Link&, const Prefix&) { return 0; }
+
+    /// Remembers the \a key of the node after the \a link.
+    template <class Link>
+    static void setKey(Link&, const Key&) {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Tower keys of InlineKeyTower.
+template <class Key>
+struct SkipListTowerKeys<Key, InlineKeyTower>
+{
+    typedef std::uint64_t Prefix;
+
+    static const bool exactPrefix = KeyPrefix<Key>::exact;
+
+    static Prefix makePrefix(const Key& key) { return KeyPrefix<Key>::get(key); }
+
+    template <class Link>
+    static int compare(const Link& link, Prefix prefix)
+    {
+        return (link.key > prefix) - (link.key < prefix);
+    }
+
+    template <class Link>
+    static void setKey(Link& link, const Key& key)
+    {
+        link.key = KeyPrefix<Key>::get(key);
+    }
+};
+
+//==============================================================================
+
 
 
 /*! ****************************************************************************
  *  \brief A node of skip-list data structure
  *
  *  The lowest (= dense) level is implemented with \a next.
- *  Warning! The most dense level is \a next, not nextJump[0]!!!
+ *  Warning! The most dense level is \a next, not jump[0]!!!
+ *
+ *  \a jump must be the last field of a node: nodes created by SkipList
+ *  take only sizeForLevel(levelHighest) bytes, i.e. their tower is cut
+ *  right after jump[levelHighest]. Never touch levels above
+ *  \a levelHighest of such a node.
+ *
+ *  Links of the sparse levels are set with setJump(), which also keeps the
+ *  prefixes in the links of the \a Layout.
  ******************************************************************************/
-template <class Value, class Key, int numLevels, class Next>
+template <class Value, class Key, int numLevels, class Next, class Layout = PlainTower>
 struct NodeSkipListAbstract
         : public NodeWithKeyAbstract<Value, Key, Next >
 {
     /// Alias for the base class.
     typedef NodeWithKeyAbstract<Value, Key, Next > Base;
 
-    /// \brief Stores Skip List sparse levels.
+    /// Alias for a link of the sparse levels.
+    typedef SkipListLink<Next, Layout> Link;
+
+    /// Alias for the keys in the links.
+    typedef SkipListTowerKeys<Key, Layout> TowerKeys;
+
+    /// What a search knows about its key.
+    typedef typename TowerKeys::Prefix Prefix;
+
+    /// Default constructor.
+    NodeSkipListAbstract()
+        : Base()
+    {}
+
+    /// Init with a key.
+    NodeSkipListAbstract(const Key& key)
+        : Base(key)
+    {}
+
+    /// Init with a key and a value.
+    NodeSkipListAbstract(const Key& key, const Value& val)
+        : Base(key, val)
+    {}
+
+    /// Returns the number of bytes needed for a node with the given
+    /// highest level (the full size for (numLevels-1)).
+    static std::size_t sizeForLevel(int levelHighest)
+    {
+        return sizeof(Next) - (numLevels - 1 - levelHighest) * sizeof(Link);
+    }
+
+    /// Returns the prefix of the searched \a key.
+    static Prefix makePrefix(const Key& key)
+    {
+        return TowerKeys::makePrefix(key);
+    }
+
+    /// Returns the number of bytes the node occupies.
+    std::size_t allocSize() const
+    {
+        return sizeForLevel(levelHighest);
+    }
+
+    /// Links the node to \a node on the sparse \a level.
+    void setJump(int level, Next* node)
+    {
+        jump[level].next = node;
+        TowerKeys::setKey(jump[level], node->key);
+    }
+
+    /// \brief Checks if the key of jump[level].next is less than \a key
+    /// having the \a prefix.
     ///
-    /// \a (numLevels-1) is the highest/sparsest level.
-    Next* nextJump[numLevels];
+    /// jump[level].next must not be the sentinel.
+    bool jumpLess(int level, const Key& key, const Prefix& prefix) const
+    {
+        int cmp = TowerKeys::compare(jump[level], prefix);
+        if (cmp != 0 || TowerKeys::exactPrefix)
+            return cmp < 0;
+
+        return jump[level].next->key < key;
+    }
+
+    /// Checks if the key of jump[level].next is not greater than \a key,
+    /// see jumpLess().
+    bool jumpNotGreater(int level, const Key& key, const Prefix& prefix) const
+    {
+        int cmp = TowerKeys::compare(jump[level], prefix);
+        if (cmp != 0 || TowerKeys::exactPrefix)
+            return cmp <= 0;
+
+        return !(key < jump[level].next->key);
+    }
 
     /// \brief Current highest level of the node
     ///
     /// Important!!
     /// -1 means that there are no sparse numLevels.
-    ///  0 = nextJump[0] is enabled and contains sparse jumps
+    ///  0 = jump[0] is enabled and contains sparse jumps
     /// (numLevels-1) is the maximal value for \a levelHighest.
     ///
     /// Note: In industrial envirnoment I would use 0 for no \a numLevels,
     /// but it may confuse students.
     int levelHighest;
+
+    /// \brief Stores Skip List sparse levels: the next nodes together with
+    /// the widths of the links and, for InlineKeyTower, the keys of the next
+    /// nodes, so all of them are cut with the tower.
+    ///
+    /// \a (numLevels-1) is the highest/sparsest level.
+    /// Only [0..levelHighest] are guaranteed to be allocated.
+    Link jump[numLevels];
 };
 
 //==============================================================================
@@ -59,13 +272,15 @@ struct NodeSkipListAbstract
 /*! ****************************************************************************
  *  Declares a node for SkipList .
  ******************************************************************************/
-template <class Value, class Key, int numLevels>
+template <class Value, class Key, int numLevels, class Layout = PlainTower>
 class NodeSkipList
-        : public NodeSkipListAbstract<Value, Key, numLevels, NodeSkipList<Value, Key, numLevels> >
+        : public NodeSkipListAbstract<Value, Key, numLevels,
+                                      NodeSkipList<Value, Key, numLevels, Layout>, Layout>
 {
 public:
     /// Alias for the base class.
-    typedef NodeSkipListAbstract<Value, Key, numLevels, NodeSkipList<Value, Key, numLevels> > Base;
+    typedef NodeSkipListAbstract<Value, Key, numLevels,
+                                 NodeSkipList<Value, Key, numLevels, Layout>, Layout> Base;
 
 public:
     /// Default constructor.
@@ -77,9 +292,18 @@ public:
     /// Init with a key and a value.
     NodeSkipList(const Key& tkey, const Value& val);
 
+    /// \brief Init with a key, a value and the highest level.
+    ///
+    /// Only levels up to \a levelHighest are touched, so the node can be
+    /// placed in sizeForLevel(levelHighest) bytes.
+    NodeSkipList(const Key& tkey, const Value& val, int levelHighest);
+
 protected:
     /// Clears all next links - dense and sparse levels and other fields.
     void clear();
+
+    /// Clears sparse links up to \a levelHighest and sets the level.
+    void clear(int levelHighest);
 };
 
 //==============================================================================
@@ -87,26 +311,51 @@ protected:
 
 
 /*! ****************************************************************************
- *  Declares SkipList.
+ *  \brief Implements skip list on top of an ordered list.
+ *
+ *  \a ListBase is either OrderedList (then the methods override its virtual
+ *  ones, see SkipList) or OrderedListBase (then nothing is virtual, see
+ *  StaticSkipList). The code is the same for both.
+ *
+ *  \a Alloc is a node allocator policy, see node_allocator.h.
+ *
+ *  \a Layout is PlainTower or InlineKeyTower. The latter lets a search
+ *  skip reading the nodes it does not move to, but takes more memory and
+ *  needs a KeyPrefix of the keys.
  ******************************************************************************/
-template <class Value, class Key, int numLevels >
-class SkipList
-        : public OrderedList < Value, Key, NodeSkipList<Value, Key, numLevels> >
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+class SkipListBase
+        : public ListBase
 {
 public:
     /// Alias for base class type.
-    typedef OrderedList<Value, Key, NodeSkipList<Value, Key, numLevels> > Base;
+    typedef ListBase Base;
 
     /// Alias for corresponding list node.
-    typedef NodeSkipList<Value,Key, numLevels> Node;
+    typedef NodeSkipList<Value,Key, numLevels, Layout> Node;
+
+    /// What a search knows about its key ahead.
+    typedef typename Node::Prefix Prefix;
 
 
     /// \brief Constructor initializes with a probability.
     /// \param probability is the probability of each sparse level to appear.
-    SkipList(double probability = 0.5);
+    SkipListBase(double probability = 0.5);
 
-    /// Virtual destructor: must take into account different levels!
-    virtual ~SkipList();
+    /// \brief Constructor initializes with a probability and a seed of the
+    /// level generator: lists with the same seed get the same node heights.
+    SkipListBase(double probability, std::uint64_t seed);
+
+    /// \brief Builds the list from an ordered range in a single pass.
+    ///
+    /// See appendSorted() for the requirements to the range.
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    SkipListBase(InputIterator first, InputIterator last, double probability = 0.5);
+
+    /// Builds the list from an ordered range with a seed of the level generator.
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    SkipListBase(InputIterator first, InputIterator last, double probability,
+                 std::uint64_t seed);
 
 
     /// \brief Insert a new element into your list.
@@ -116,7 +365,10 @@ public:
     ///
     /// Make different test. Check border cases - empty list, end of the list,
     /// et cetera ...
-    virtual void insert(const Value& val, const Key& key);
+    ///
+    /// A key not less than the last one is linked right after the tails of
+    /// the levels in O(numLevels), with no searching (the "fast path").
+    void insert(const Value& val, const Key& key);
 
     /// \brief Remove the node from the list and delete it from the memory.
     ///
@@ -126,7 +378,7 @@ public:
     ///
     /// Continue to think hard about sparse levels.
     /// Check different cases.
-    virtual void removeNext(Node* nodeBefore);
+    void removeNext(Node* nodeBefore);
 
     /// \brief Find the last element with key strictly less than key.
     ///
@@ -134,7 +386,7 @@ public:
     /// correctly from the highest to the lowest.
     /// 
     /// If the key is less than the first element or the list is empty, returns _preHead.
-    virtual Node* findLastLessThan(const Key& key) const;
+    Node* findLastLessThan(const Key& key) const;
 
     /// \brief Find the first element with key equal to key.
     ///
@@ -142,13 +394,216 @@ public:
     /// correctly from the highest to the lowest.
     /// 
     /// If nothing was found, returns nullptr.
-    virtual Node* findFirst(const Key& key) const;
+    Node* findFirst(const Key& key) const;
+
+    /// \brief Find the last element with key less than or equal to key.
+    ///
+    /// If the key is less than the first element or the list is empty, returns _preHead.
+    Node* findLastNotGreaterThan(const Key& key) const;
+
+    /// \brief Finger search: finds the last element with key strictly less
+    /// than \a key starting from the \a hint node.
+    ///
+    /// If \a hint is before the result (e.g. it is a result of a previous
+    /// search for a smaller key), the search climbs up from the hint and then
+    /// goes down, which takes O(log d) time, d being the distance between the
+    /// hint and the result. Otherwise it is an ordinary search.
+    Node* findLastLessThan(const Key& key, Node* hint) const;
+
+    /// Finger search for the first element with key equal to \a key,
+    /// see findLastLessThan(key, hint).
+    Node* findFirst(const Key& key, Node* hint) const;
+
+    /// \brief Finds the last node of the list in constant time.
+    ///
+    /// If the list is empty, returns _preHead.
+    Node* findLast() const;
+
+    /// \brief Appends an ordered range to the end of the list in linear time.
+    ///
+    /// Elements of the range are pairs (key, value), like std::pair<Key, Value>,
+    /// with non-decreasing keys, and the first key must not be less than the
+    /// last key of the list. The nodes are linked on all levels at once with
+    /// no searching, so equal keys keep the order of the range.
+    ///
+    /// Throws std::invalid_argument on the first element breaking the order;
+    /// the elements before it stay in the list.
+    template <class InputIterator>
+    void appendSorted(InputIterator first, InputIterator last);
+
+    /// Returns the number of insertions that took the fast path.
+    std::size_t getFastPathInsertCount() const { return _fastPathInserts; }
+
+    /// Returns the number of elements in the list in constant time.
+    std::size_t size() const { return _size; }
+
+    /// \brief Returns the number of elements with key strictly less than
+    /// \a key in O(log n) time.
+    ///
+    /// It is the index of the first element not less than \a key.
+    std::size_t rank(const Key& key) const;
+
+    /// \brief Returns the element with the (zero-based) index \a k in
+    /// O(log n) time.
+    ///
+    /// If \a k is not less than size(), returns nullptr.
+    Node* select(std::size_t k) const;
+
+protected:
+    /// Links the sentinel to itself on every level.
+    void initPreHead();
+
+    /// \brief Checks if the tails are the last nodes on the dense level and
+    /// on sparse levels up to \a levelHighest.
+    ///
+    /// The methods of the list keep them valid; it is checked in debug builds.
+    bool tailsValid(int levelHighest) const;
+
+    /// Finds the tails of all levels with a search.
+    void restoreTails() const;
+
+    /// \brief Links the \a node after the tails and makes it the new tail.
+    ///
+    /// The tails of all the levels must be valid: the spans of the ones
+    /// above the node grow as well.
+    void linkAfterTails(Node* node);
+
+    /// \brief Recounts the size, the spans and the tower keys of all links
+    /// and finds the tails in O(n) time.
+    ///
+    /// It is needed only for nodes linked by hand, bypassing the methods of
+    /// the list, as the test fixtures do.
+    void restoreIndex();
+
+    using Base::newNode;
+
+    /// Creates a node with a tower of exactly (levelHighest + 1) sparse levels.
+    Node* newNode(const Key& key, const Value& val, int levelHighest);
+
+    /// Generates the highest level for a new node: -1 with probability
+    /// (1 - p), 0 with probability p(1 - p) and so on up to (numLevels-1).
+    int generateLevel();
 
 protected:
     /// Stores the probability of the next level to appear.
     double _probability;
+
+    /// Draws the heights of new nodes.
+    LevelGenerator _levelGenerator;
+
+    /// Last node of the dense level (_preHead if the list is empty).
+    mutable Node* _tail;
+
+    /// Last nodes of sparse levels.
+    mutable Node* _tailJump[numLevels];
+
+    /// Number of insertions that took the fast path.
+    std::size_t _fastPathInserts;
+
+    /// Number of elements.
+    std::size_t _size;
+}; // class SkipListBase
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  Declares SkipList.
+ *
+ *  SkipList is an OrderedList: its major methods are virtual.
+ ******************************************************************************/
+template <class Value, class Key, int numLevels, class Alloc = HeapNodeAllocator,
+          class Layout = PlainTower>
+class SkipList
+        : public SkipListBase<Value, Key, numLevels, Alloc, Layout,
+                              OrderedList<Value, Key, NodeSkipList<Value, Key, numLevels, Layout>,
+                                          Alloc> >
+{
+public:
+    /// Alias for base class type.
+    typedef SkipListBase<Value, Key, numLevels, Alloc, Layout,
+                         OrderedList<Value, Key, NodeSkipList<Value, Key, numLevels, Layout>,
+                                     Alloc> > Base;
+
+    /// \brief Constructor initializes with a probability.
+    /// \param probability is the probability of each sparse level to appear.
+    SkipList(double probability = 0.5)
+        : Base(probability)
+    { }
+
+    /// Initializes with a probability and a seed of the level generator.
+    SkipList(double probability, std::uint64_t seed)
+        : Base(probability, seed)
+    { }
+
+    /// Builds the list from an ordered range, see SkipListBase::appendSorted().
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    SkipList(InputIterator first, InputIterator last, double probability = 0.5)
+        : Base(first, last, probability)
+    { }
+
+    /// Builds the list from an ordered range with a seed of the level generator.
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    SkipList(InputIterator first, InputIterator last, double probability, std::uint64_t seed)
+        : Base(first, last, probability, seed)
+    { }
+
+    /// Virtual destructor: must take into account different levels!
+    virtual ~SkipList() { }
 }; // class SkipList
 
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Skip list with no virtual methods.
+ *
+ *  Has the same semantics as SkipList, but every call, including the inner
+ *  ones (e.g. findFirst() -> findLastLessThan()), is statically bound and
+ *  can be inlined. Use it when the list is not used through OrderedList.
+ ******************************************************************************/
+template <class Value, class Key, int numLevels, class Alloc = HeapNodeAllocator,
+          class Layout = PlainTower>
+class StaticSkipList
+        : public SkipListBase<Value, Key, numLevels, Alloc, Layout,
+                              OrderedListBase<StaticSkipList<Value, Key, numLevels, Alloc, Layout>,
+                                              Value, Key,
+                                              NodeSkipList<Value, Key, numLevels, Layout>,
+                                              Alloc> >
+{
+public:
+    /// Alias for base class type.
+    typedef SkipListBase<Value, Key, numLevels, Alloc, Layout,
+                         OrderedListBase<StaticSkipList<Value, Key, numLevels, Alloc, Layout>,
+                                         Value, Key, NodeSkipList<Value, Key, numLevels, Layout>,
+                                         Alloc> > Base;
+
+    /// \brief Constructor initializes with a probability.
+    /// \param probability is the probability of each sparse level to appear.
+    StaticSkipList(double probability = 0.5)
+        : Base(probability)
+    { }
+
+    /// Initializes with a probability and a seed of the level generator.
+    StaticSkipList(double probability, std::uint64_t seed)
+        : Base(probability, seed)
+    { }
+
+    /// Builds the list from an ordered range, see SkipListBase::appendSorted().
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    StaticSkipList(InputIterator first, InputIterator last, double probability = 0.5)
+        : Base(first, last, probability)
+    { }
+
+    /// Builds the list from an ordered range with a seed of the level generator.
+    template <class InputIterator, class = EnableIfInputIterator<InputIterator> >
+    StaticSkipList(InputIterator first, InputIterator last, double probability, std::uint64_t seed)
+        : Base(first, last, probability, seed)
+    { }
+}; // class StaticSkipList
+
 
 //==============================================================================
 
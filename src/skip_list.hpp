@@ -11,66 +11,638 @@
 
 // !!! DO NOT include skip_list.h here, 'cause it leads to circular refs. !!!
 
-#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <stdexcept>
 
 //==============================================================================
 // class NodeSkipList
 //==============================================================================
 
-template <class Value, class Key, int numLevels>
-void NodeSkipList<Value, Key, numLevels>::clear(void)
+template <class Value, class Key, int numLevels, class Layout>
+void NodeSkipList<Value, Key, numLevels, Layout>::clear(void)
 {
-    for (int i = 0; i < numLevels; ++i)
-        Base::nextJump[i] = 0;
+    clear(numLevels - 1);
 
     Base::levelHighest = -1;
 }
 
 //------------------------------------------------------------------------------
 
-template <class Value, class Key, int numLevels>
-NodeSkipList<Value, Key, numLevels>::NodeSkipList(void)
+template <class Value, class Key, int numLevels, class Layout>
+void NodeSkipList<Value, Key, numLevels, Layout>::clear(int levelHighest)
 {
-    clear();
+    for (int i = 0; i <= levelHighest; ++i)
+    {
+        Base::jump[i].next = 0;
+        Base::jump[i].span = 0;
+    }
+
+    Base::levelHighest = levelHighest;
 }
 
 //------------------------------------------------------------------------------
 
-template <class Value, class Key, int numLevels>
-NodeSkipList<Value, Key, numLevels>::NodeSkipList(const Key& tkey)
+template <class Value, class Key, int numLevels, class Layout>
+NodeSkipList<Value, Key, numLevels, Layout>::NodeSkipList(void)
 {
     clear();
+}
+
+//------------------------------------------------------------------------------
 
-    Base::Base::key = tkey;
+template <class Value, class Key, int numLevels, class Layout>
+NodeSkipList<Value, Key, numLevels, Layout>::NodeSkipList(const Key& tkey)
+    : Base(tkey)
+{
+    clear();
 }
 
 //------------------------------------------------------------------------------
 
-template <class Value, class Key, int numLevels>
-NodeSkipList<Value, Key, numLevels>::NodeSkipList(const Key& tkey, const Value& val)
+template <class Value, class Key, int numLevels, class Layout>
+NodeSkipList<Value, Key, numLevels, Layout>::NodeSkipList(const Key& tkey, const Value& val)
+    : Base(tkey, val)
 {
     clear();
+}
 
-    Base::Base::key = tkey;
-    Base::Base::value = val;
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Layout>
+NodeSkipList<Value, Key, numLevels, Layout>::NodeSkipList(const Key& tkey, const Value& val,
+                                                  int levelHighest)
+    : Base(tkey, val)
+{
+    clear(levelHighest);
 }
 
 
 //==============================================================================
-// class SkipList
+// class SkipListBase
 //==============================================================================
 
-template <class Value, class Key, int numLevels>
-SkipList<Value, Key, numLevels>::SkipList(double probability)
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::SkipListBase(double probability)
+    : _probability(probability)
+    , _levelGenerator(probability, numLevels)
+{
+    initPreHead();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::SkipListBase(double probability,
+                                                                   std::uint64_t seed)
+    : _probability(probability)
+    , _levelGenerator(probability, numLevels, seed)
+{
+    initPreHead();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+template <class InputIterator, class>
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::SkipListBase(InputIterator first, InputIterator last,
+                                                 double probability)
+    : _probability(probability)
+    , _levelGenerator(probability, numLevels)
+{
+    initPreHead();
+    appendSorted(first, last);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+template <class InputIterator, class>
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::SkipListBase(InputIterator first, InputIterator last,
+                                                 double probability, std::uint64_t seed)
+    : _probability(probability)
+    , _levelGenerator(probability, numLevels, seed)
+{
+    initPreHead();
+    appendSorted(first, last);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::insert(const Value& val, const Key& key)
+{
+    Node* preHead = Base::_preHead;
+
+    SKIP_LIST_COUNT_CALL(OP_INSERT);
+
+    int levelHighest = generateLevel();
+
+    // fast path: the key goes to the very end
+    assert(tailsValid(numLevels - 1));
+    if (_tail == preHead || !(key < _tail->key))
+    {
+        linkAfterTails(newNode(key, val, levelHighest));
+        ++_fastPathInserts;
+        return;
+    }
+
+    // last nodes with a key not greater than the given one on each sparse
+    // level: equal keys keep the order of insertion; positions of the nodes
+    // are counted for the spans
+    Node* update[numLevels];
+    std::size_t updateRank[numLevels];
+
+    const Prefix prefix = Node::makePrefix(key);
+    Node* run = preHead;
+    std::size_t rank = 0;
+    for (int i = numLevels - 1; i >= 0; --i)
+    {
+        while (run->jump[i].next != preHead && run->jumpNotGreater(i, key, prefix))
+        {
+            SKIP_LIST_COUNT_HOP(i);
+            rank += run->jump[i].span;
+            run = run->jump[i].next;
+        }
+
+        update[i] = run;
+        updateRank[i] = rank;
+    }
+
+    while (run->next != preHead && !(key < run->next->key))
+    {
+        SKIP_LIST_COUNT_HOP(-1);
+        ++rank;
+        run = run->next;
+    }
+
+    Node* node = newNode(key, val, levelHighest);
+
+    node->next = run->next;
+    run->next = node;
+    if (node->next == preHead)
+        _tail = node;
+
+    // the node gets position (rank + 1)
+    for (int i = 0; i <= node->levelHighest; ++i)
+    {
+        node->setJump(i, update[i]->jump[i].next);
+        update[i]->setJump(i, node);
+        if (node->jump[i].next == preHead)
+            _tailJump[i] = node;
+
+        node->jump[i].span = update[i]->jump[i].span - (rank - updateRank[i]);
+        update[i]->jump[i].span = rank - updateRank[i] + 1;
+    }
+
+    for (int i = node->levelHighest + 1; i < numLevels; ++i)
+        ++update[i]->jump[i].span;
+
+    ++_size;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::removeNext(Node* nodeBefore)
+{
+    Node* preHead = Base::_preHead;
+
+    if (nodeBefore == nullptr || nodeBefore->next == nullptr
+        || nodeBefore->next == preHead)
+    {
+        throw std::invalid_argument("There is no node after the given one");
+    }
+
+    Node* target = nodeBefore->next;
+
+    // for each sparse level the node can be reached only through nodes with
+    // keys less than or equal to its own one
+    Node* less[numLevels];
+    std::size_t lessRank[numLevels];
+
+    const Prefix prefix = Node::makePrefix(target->key);
+    Node* run = preHead;
+    std::size_t rank = 0;
+    for (int i = numLevels - 1; i >= 0; --i)
+    {
+        while (run->jump[i].next != preHead && run->jumpLess(i, target->key, prefix))
+        {
+            rank += run->jump[i].span;
+            run = run->jump[i].next;
+        }
+
+        less[i] = run;
+        lessRank[i] = rank;
+    }
+
+    // position of the target: equal keys can be told apart only by it
+    while (run != target)
+    {
+        ++rank;
+        run = run->next;
+    }
+
+    for (int i = numLevels - 1; i >= 0; --i)
+    {
+        // equal keys are scanned with a separate pointer: lower levels must
+        // start before the target
+        Node* scan = less[i];
+        std::size_t scanRank = lessRank[i];
+
+        if (i > target->levelHighest)
+        {
+            // the link jumping over the target becomes one step shorter
+            while (scan->jump[i].next != preHead && scanRank + scan->jump[i].span < rank)
+            {
+                scanRank += scan->jump[i].span;
+                scan = scan->jump[i].next;
+            }
+
+            --scan->jump[i].span;
+            continue;
+        }
+
+        while (scan->jump[i].next != target)
+            scan = scan->jump[i].next;
+
+        scan->setJump(i, target->jump[i].next);
+        scan->jump[i].span += target->jump[i].span - 1;
+        if (_tailJump[i] == target)
+            _tailJump[i] = scan;
+    }
+
+    nodeBefore->next = target->next;
+    if (_tail == target)
+        _tail = nodeBefore;
+
+    Base::deleteNode(target);
+    --_size;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findLastLessThan(const Key& key) const
+{
+    Node* preHead = Base::_preHead;
+
+    SKIP_LIST_COUNT_CALL(OP_FIND_LAST_LESS);
+
+    const Prefix prefix = Node::makePrefix(key);
+    Node* run = preHead;
+    for (int i = numLevels - 1; i >= 0; --i)
+        while (run->jump[i].next != preHead && run->jumpLess(i, key, prefix))
+        {
+            SKIP_LIST_COUNT_HOP(i);
+            run = run->jump[i].next;
+        }
+
+    while (run->next != preHead && run->next->key < key)
+    {
+        SKIP_LIST_COUNT_HOP(-1);
+        run = run->next;
+    }
+
+    return run;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findFirst(const Key& key) const
+{
+    SKIP_LIST_COUNT_CALL(OP_FIND_FIRST);
+
+    Node* node = findLastLessThan(key)->next;
+    if (node == Base::_preHead || !(node->key == key))
+        return nullptr;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findLastNotGreaterThan(const Key& key) const
+{
+    Node* preHead = Base::_preHead;
+
+    SKIP_LIST_COUNT_CALL(OP_FIND_LAST_NOT_GREATER);
+
+    const Prefix prefix = Node::makePrefix(key);
+    Node* run = preHead;
+    for (int i = numLevels - 1; i >= 0; --i)
+        while (run->jump[i].next != preHead && run->jumpNotGreater(i, key, prefix))
+        {
+            SKIP_LIST_COUNT_HOP(i);
+            run = run->jump[i].next;
+        }
+
+    while (run->next != preHead && !(key < run->next->key))
+    {
+        SKIP_LIST_COUNT_HOP(-1);
+        run = run->next;
+    }
+
+    return run;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findLastLessThan(const Key& key, Node* hint) const
+{
+    Node* preHead = Base::_preHead;
+
+    if (hint == nullptr || hint == preHead || !(hint->key < key))
+        return findLastLessThan(key);
+
+    SKIP_LIST_COUNT_CALL(OP_FIND_LAST_LESS);
+
+    // climbing: go along the highest level of the current node while the
+    // next node is still before the key; taller nodes lift us up
+    const Prefix prefix = Node::makePrefix(key);
+    Node* run = hint;
+    int level = run->levelHighest;
+    for (;;)
+    {
+        Node* next = level < 0 ? run->next : run->jump[level].next;
+        if (next == preHead
+                || !(level < 0 ? next->key < key : run->jumpLess(level, key, prefix)))
+            break;
+
+        SKIP_LIST_COUNT_HOP(level);
+        run = next;
+        if (run->levelHighest > level)
+            level = run->levelHighest;
+    }
+
+    // descending, as in the ordinary search
+    for (int i = level; i >= 0; --i)
+        while (run->jump[i].next != preHead && run->jumpLess(i, key, prefix))
+        {
+            SKIP_LIST_COUNT_HOP(i);
+            run = run->jump[i].next;
+        }
+
+    while (run->next != preHead && run->next->key < key)
+    {
+        SKIP_LIST_COUNT_HOP(-1);
+        run = run->next;
+    }
+
+    return run;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findFirst(const Key& key, Node* hint) const
+{
+    SKIP_LIST_COUNT_CALL(OP_FIND_FIRST);
+
+    Node* node = findLastLessThan(key, hint)->next;
+    if (node == Base::_preHead || !(node->key == key))
+        return nullptr;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+std::size_t SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::rank(const Key& key) const
+{
+    Node* preHead = Base::_preHead;
+
+    const Prefix prefix = Node::makePrefix(key);
+    Node* run = preHead;
+    std::size_t rank = 0;
+    for (int i = numLevels - 1; i >= 0; --i)
+        while (run->jump[i].next != preHead && run->jumpLess(i, key, prefix))
+        {
+            rank += run->jump[i].span;
+            run = run->jump[i].next;
+        }
+
+    while (run->next != preHead && run->next->key < key)
+    {
+        ++rank;
+        run = run->next;
+    }
+
+    return rank;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::select(std::size_t k) const
+{
+    if (k >= _size)
+        return nullptr;
+
+    Node* preHead = Base::_preHead;
+
+    // the element has position (k + 1), the sentinel has position 0
+    Node* run = preHead;
+    std::size_t rank = 0;
+    for (int i = numLevels - 1; i >= 0; --i)
+        while (run->jump[i].next != preHead && rank + run->jump[i].span <= k + 1)
+        {
+            rank += run->jump[i].span;
+            run = run->jump[i].next;
+        }
+
+    for (; rank < k + 1; ++rank)
+        run = run->next;
+
+    return run;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::findLast() const
+{
+    assert(tailsValid(-1));
+
+    return _tail;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+template <class InputIterator>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::appendSorted(InputIterator first,
+                                                          InputIterator last)
+{
+    if (first == last)
+        return;
+
+    assert(tailsValid(numLevels - 1));
+
+    for (; first != last; ++first)
+    {
+        if (_tail != Base::_preHead && first->first < _tail->key)
+            throw std::invalid_argument("Appended keys must not decrease");
+
+        linkAfterTails(newNode(first->first, first->second, generateLevel()));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::initPreHead()
 {
-    _probability = probability;
+    Node* preHead = Base::_preHead;
 
     // Lets use m_pPreHead as a final sentinel element
     for (int i = 0; i < numLevels; ++i)
-        Base::_preHead->nextJump[i] = Base::_preHead;
+    {
+        preHead->setJump(i, preHead);
+        preHead->jump[i].span = 1;
+        _tailJump[i] = preHead;
+    }
 
-    Base::_preHead->levelHighest = numLevels - 1;
+    preHead->levelHighest = numLevels - 1;
+
+    _tail = preHead;
+    _fastPathInserts = 0;
+    _size = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+bool SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::tailsValid(int levelHighest) const
+{
+    Node* preHead = Base::_preHead;
+
+    if (_tail->next != preHead)
+        return false;
+
+    for (int i = 0; i <= levelHighest; ++i)
+        if (_tailJump[i]->jump[i].next != preHead)
+            return false;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::restoreTails() const
+{
+    Node* preHead = Base::_preHead;
+
+    Node* run = preHead;
+    for (int i = numLevels - 1; i >= 0; --i)
+    {
+        while (run->jump[i].next != preHead)
+            run = run->jump[i].next;
+
+        _tailJump[i] = run;
+    }
+
+    while (run->next != preHead)
+        run = run->next;
+
+    _tail = run;
 }
 
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::linkAfterTails(Node* node)
+{
+    Node* preHead = Base::_preHead;
+
+    node->next = preHead;
+    _tail->next = node;
+    _tail = node;
+
+    // the spans of the old tails do not change: the sentinel stood where
+    // the node is now
+    for (int i = 0; i <= node->levelHighest; ++i)
+    {
+        node->setJump(i, preHead);
+        node->jump[i].span = 1;
+        _tailJump[i]->setJump(i, node);
+        _tailJump[i] = node;
+    }
+
+    for (int i = node->levelHighest + 1; i < numLevels; ++i)
+        ++_tailJump[i]->jump[i].span;
 
-    // TODO: !!! One need to implement all declared methods !!!
+    ++_size;
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+void SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::restoreIndex()
+{
+    Node* preHead = Base::_preHead;
+
+    // the last node seen on each level and its position
+    Node* last[numLevels];
+    std::size_t lastRank[numLevels];
+    for (int i = 0; i < numLevels; ++i)
+    {
+        last[i] = preHead;
+        lastRank[i] = 0;
+    }
+
+    std::size_t rank = 0;
+    for (Node* run = preHead->next; run != preHead; run = run->next)
+    {
+        ++rank;
+        for (int i = 0; i <= run->levelHighest; ++i)
+        {
+            last[i]->setJump(i, run);
+            last[i]->jump[i].span = rank - lastRank[i];
+            last[i] = run;
+            lastRank[i] = rank;
+        }
+    }
+
+    // the last link of each level leads to the sentinel, whatever it was
+    for (int i = 0; i < numLevels; ++i)
+    {
+        last[i]->setJump(i, preHead);
+        last[i]->jump[i].span = rank + 1 - lastRank[i];
+    }
+
+    _size = rank;
+
+    restoreTails();
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+typename SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::Node*
+SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::newNode(const Key& key, const Value& val,
+                                                int levelHighest)
+{
+    void* mem = Base::_alloc.allocate(Node::sizeForLevel(levelHighest));
+    return new (mem) Node(key, val, levelHighest);
+}
+
+//------------------------------------------------------------------------------
+
+template <class Value, class Key, int numLevels, class Alloc, class Layout, class ListBase>
+int SkipListBase<Value, Key, numLevels, Alloc, Layout, ListBase>::generateLevel()
+{
+    return _levelGenerator.generate();
+}
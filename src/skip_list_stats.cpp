@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  skip_list_stats.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "skip_list_stats.h"
+
+//==============================================================================
+// struct SkipListStats
+//==============================================================================
+
+const int SkipListStats::NUM_LEVELS;
+
+//------------------------------------------------------------------------------
+
+SkipListStats& SkipListStats::local()
+{
+    // zero-initialized, as any thread-local object of a POD type
+    static thread_local SkipListStats stats;
+
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+
+const char* SkipListStats::getName(Operation op)
+{
+    static const char* const NAMES[NUM_OPERATIONS] =
+        { "insert", "find_first", "find_last_less", "find_last_not_greater" };
+
+    return NAMES[op];
+}
+
+//------------------------------------------------------------------------------
+
+void SkipListStats::reset()
+{
+    for (int i = 0; i < NUM_OPERATIONS; ++i)
+        calls[i] = 0;
+
+    for (int i = 0; i < NUM_LEVELS; ++i)
+        hops[i] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+std::uint64_t SkipListStats::getTotalHops() const
+{
+    std::uint64_t total = 0;
+    for (int i = 0; i < NUM_LEVELS; ++i)
+        total += hops[i];
+
+    return total;
+}
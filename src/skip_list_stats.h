@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 SkipListStats.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_SKIP_LIST_STATS_H_
+#define CYBERPOLICE_SKIP_LIST_STATS_H_
+
+#include <cstdint>
+
+
+/*! ****************************************************************************
+ *  \brief Counts the work of skip list operations on the current thread.
+ *
+ *  The counting is compiled in only with CYBERPOLICE_INSTRUMENT defined
+ *  (the CMake option of the same name); otherwise the SKIP_LIST_COUNT_*
+ *  macros expand to nothing and the lists do not touch the counters.
+ ******************************************************************************/
+struct SkipListStats
+{
+    /// Counted operations.
+    enum Operation
+    {
+        OP_INSERT,
+        OP_FIND_FIRST,
+        OP_FIND_LAST_LESS,
+        OP_FIND_LAST_NOT_GREATER,
+        NUM_OPERATIONS
+    };
+
+    /// Number of counted levels: the dense one and up to 63 sparse ones.
+    static const int NUM_LEVELS = 64;
+
+    /// Whether the counting is compiled in.
+    static bool isEnabled()
+    {
+#ifdef CYBERPOLICE_INSTRUMENT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// Returns the counters of the current thread.
+    static SkipListStats& local();
+
+    /// Returns the name of the operation, e.g. "insert".
+    static const char* getName(Operation op);
+
+    /// Sets all the counters to zero.
+    void reset();
+
+    /// Returns the number of hops on all the levels.
+    std::uint64_t getTotalHops() const;
+
+    /// Calls of each operation.
+    std::uint64_t calls[NUM_OPERATIONS];
+
+    /// Hops, i.e. moves to the next node: hops[0] on the dense level,
+    /// hops[i + 1] on the sparse level i.
+    std::uint64_t hops[NUM_LEVELS];
+}; // struct SkipListStats
+
+
+#ifdef CYBERPOLICE_INSTRUMENT
+
+/// Counts a call of the operation \a op.
+#define SKIP_LIST_COUNT_CALL(op) \
+    (++SkipListStats::local().calls[SkipListStats::op])
+
+/// Counts a hop on the \a level, -1 for the dense one.
+#define SKIP_LIST_COUNT_HOP(level) \
+    (++SkipListStats::local().hops[(level) + 1])
+
+#else
+
+#define SKIP_LIST_COUNT_CALL(op) ((void)0)
+#define SKIP_LIST_COUNT_HOP(level) ((void)0)
+
+#endif // CYBERPOLICE_INSTRUMENT
+
+
+#endif // CYBERPOLICE_SKIP_LIST_STATS_H_
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  string_interner.h/cpp
+////////////////////////////////////////////////////////////////////////////////
+
+#include "string_interner.h"
+
+#include <cstring>
+#include <stdexcept>
+
+//==============================================================================
+// class StringInterner
+//==============================================================================
+
+const StringInterner::Id StringInterner::NOT_FOUND;
+const std::size_t StringInterner::MIN_SLOTS;
+
+//------------------------------------------------------------------------------
+
+StringInterner::StringInterner()
+    : _slots(MIN_SLOTS, NOT_FOUND)
+{
+}
+
+//------------------------------------------------------------------------------
+
+StringInterner::Id StringInterner::intern(const char* str, std::size_t len)
+{
+    std::size_t hashValue = hash(str, len);
+    std::size_t slot = findSlot(str, len, hashValue);
+    if (_slots[slot] != NOT_FOUND)
+        return _slots[slot];
+
+    if (_strings.size() == NOT_FOUND)
+        throw std::length_error("StringInterner: too many strings");
+
+    Id id = static_cast<Id>(_strings.size());
+    _strings.push_back(std::string(str, len));
+    _hashes.push_back(hashValue);
+    _slots[slot] = id;
+
+    // the table is kept at most half full
+    if (_strings.size() * 2 > _slots.size())
+        grow();
+
+    return id;
+}
+
+//------------------------------------------------------------------------------
+
+StringInterner::Id StringInterner::find(const char* str, std::size_t len) const
+{
+    return _slots[findSlot(str, len, hash(str, len))];
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t StringInterner::hash(const char* str, std::size_t len)
+{
+    std::uint64_t h = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        h ^= static_cast<unsigned char>(str[i]);
+        h *= 1099511628211ULL;
+    }
+
+    return static_cast<std::size_t>(h);
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t StringInterner::findSlot(const char* str, std::size_t len,
+                                     std::size_t hashValue) const
+{
+    std::size_t mask = _slots.size() - 1;
+    for (std::size_t slot = hashValue & mask; ; slot = (slot + 1) & mask)
+    {
+        Id id = _slots[slot];
+        if (id == NOT_FOUND)
+            return slot;
+
+        const std::string& candidate = _strings[id];
+        if (_hashes[id] == hashValue && candidate.size() == len
+            && std::memcmp(candidate.data(), str, len) == 0)
+        {
+            return slot;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void StringInterner::grow()
+{
+    std::vector<Id> slots(_slots.size() * 2, NOT_FOUND);
+    std::size_t mask = slots.size() - 1;
+
+    for (Id id = 0; id < _strings.size(); ++id)
+    {
+        std::size_t slot = _hashes[id] & mask;
+        while (slots[slot] != NOT_FOUND)
+            slot = (slot + 1) & mask;
+
+        slots[slot] = id;
+    }
+
+    _slots.swap(slots);
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Contains interfaces for the following classes:
+///                 StringInterner.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYBERPOLICE_STRING_INTERNER_H_
+#define CYBERPOLICE_STRING_INTERNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+/*! ****************************************************************************
+ *  \brief Dictionary of strings, which gives each distinct string a small
+ *  integer id.
+ *
+ *  Ids are dense: the n-th distinct string gets id n - 1, so they can index
+ *  arrays. Lookups take a pointer and a length, so a string cut from a log
+ *  line is found with no std::string created. Strings are never removed.
+ ******************************************************************************/
+class StringInterner
+{
+public:
+    /// Id of an interned string.
+    typedef std::uint32_t Id;
+
+public:
+    // Constants
+
+    /// Returned by find() for unknown strings.
+    static const Id NOT_FOUND = 0xFFFFFFFFu;
+
+    /// Number of slots of the hash table of an empty dictionary.
+    static const std::size_t MIN_SLOTS = 64;
+
+public:
+    /// Default constructor.
+    StringInterner();
+
+    /// \brief Returns the id of the string [\a str, \a str + \a len), adds
+    /// the string to the dictionary if it is not there yet.
+    Id intern(const char* str, std::size_t len);
+
+    /// Returns the id of \a str, adds it if it is not there yet.
+    Id intern(const std::string& str) { return intern(str.data(), str.size()); }
+
+    /// Returns the id of the string [\a str, \a str + \a len) or NOT_FOUND.
+    Id find(const char* str, std::size_t len) const;
+
+    /// Returns the id of \a str or NOT_FOUND.
+    Id find(const std::string& str) const { return find(str.data(), str.size()); }
+
+    /// \brief Returns the string with the given \a id.
+    ///
+    /// References stay valid while the dictionary lives.
+    const std::string& get(Id id) const { return _strings[id]; }
+
+    /// Returns the number of distinct strings.
+    std::size_t size() const { return _strings.size(); }
+
+protected:
+    /// FNV-1a hash of the string.
+    static std::size_t hash(const char* str, std::size_t len);
+
+    /// \brief Returns the slot holding the string or the empty slot where it
+    /// must be placed.
+    std::size_t findSlot(const char* str, std::size_t len, std::size_t hashValue) const;
+
+    /// Doubles the number of slots.
+    void grow();
+
+protected:
+    /// Strings in the order of ids. A deque never moves its elements.
+    std::deque<std::string> _strings;
+
+    /// Hashes of the strings, to rehash and to skip most comparisons.
+    std::vector<std::size_t> _hashes;
+
+    /// Open addressing hash table with linear probing: ids or NOT_FOUND for
+    /// empty slots. The size is a power of two.
+    std::vector<Id> _slots;
+}; // class StringInterner
+
+
+#endif // CYBERPOLICE_STRING_INTERNER_H_
@@ -11,142 +11,265 @@
 
 
 #include "time_stamp.h"
+#include "log_tokenizer.h"
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+
+/// Rounds the quotient down, not toward zero.
+static inline std::int64_t floorDiv(std::int64_t a, std::int64_t b)
+{
+    std::int64_t q = a / b;
+    return (a % b < 0) ? q - 1 : q;
+}
+
+/// Writes exactly \a count decimal digits of \a value.
+static inline void writeDigits(char* buf, int value, int count)
+{
+    for (int i = count - 1; i >= 0; --i)
+    {
+        buf[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+const std::int64_t TimeStamp::MICROS_PER_SEC;
 
 //-----------------------------------------------------------------------------
 
 TimeStamp::TimeStamp()
 {
     time_t tmp = time(nullptr);
-    _time = *localtime(&tmp);      // разыменовываем результат-структуру и копируем большой объект
+    struct tm now = *localtime(&tmp);
+
+    assign(now.tm_year + 1900, now.tm_mon + 1, now.tm_mday,
+           now.tm_hour, now.tm_min, now.tm_sec);
 }
 
 //-----------------------------------------------------------------------------
 
 // Constructor with parameters
-TimeStamp::TimeStamp(int year, int mon, int mday, int hour, int min, int sec)
+TimeStamp::TimeStamp(int year, int mon, int mday, int hour, int min, int sec, int usec)
+{
+    assign(year, mon, mday, hour, min, sec, usec);
+}
+
+//-----------------------------------------------------------------------------
+
+std::int64_t TimeStamp::getSeconds() const
+{
+    return floorDiv(_micros, MICROS_PER_SEC);
+}
+
+//-----------------------------------------------------------------------------
+
+const char* TimeStamp::parse(const char* begin, const char* end)
 {
-    _time.tm_year = year-1900;
-    // because tm_mon should be between 0 and 11!!!!!!
-    _time.tm_mon  = mon-1;
-    _time.tm_mday = mday;
-    _time.tm_hour = hour;
-    _time.tm_min  = min;
-    _time.tm_sec  = sec;
-	normalize();
+    int fields[LogTokenizer::STAMP_FIELDS];
+    if (!LogTokenizer::parseStamp(begin, end, fields))
+        return nullptr;
+
+    int usec = 0;
+    const char* p = begin + SIZE_STRTIME;
+    if (p != end && *p == '.')
+    {
+        p = parseFraction(p + 1, end, usec);
+        if (p == nullptr)
+            return nullptr;
+    }
+
+    assign(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], usec);
+
+    return p;
 }
 
 //-----------------------------------------------------------------------------
 
-// Auxiliary comparison function for time stamps
-int TimeStamp::compareTo (const TimeStamp & another) const
+const char* TimeStamp::parseFraction(const char* pos, const char* end, int& usec)
 {
-    if (_time.tm_year > another._time.tm_year)
-        return 1;
+    const int MAX_DIGITS = 9;
 
-    if (_time.tm_year == another._time.tm_year)
-	{
-        if (_time.tm_mon > another._time.tm_mon)
-            return 1;
+    int digits = 0;
+    usec = 0;
+    for (; pos != end && static_cast<unsigned>(*pos - '0') <= 9; ++pos, ++digits)
+        if (digits < 6)
+            usec = usec * 10 + (*pos - '0');
 
-        if (_time.tm_mon == another._time.tm_mon)
-		{
-            if (_time.tm_mday > another._time.tm_mday)
-                return 1;
+    if (digits == 0 || digits > MAX_DIGITS)
+        return nullptr;
 
-            if (_time.tm_mday == another._time.tm_mday)
-			{
-                if (_time.tm_hour > another._time.tm_hour)
-                    return 1;
-                if (_time.tm_hour == another._time.tm_hour)
-				{
-                    if (_time.tm_min > another._time.tm_min)
-                        return 1;
+    // .12 is 120000 microseconds
+    for (; digits < 6; ++digits)
+        usec *= 10;
 
-                    if (_time.tm_min == another._time.tm_min)
-					{
-                        if (_time.tm_sec > another._time.tm_sec)
-                            return 1;
+    return pos;
+}
+
+//-----------------------------------------------------------------------------
 
-                        if (_time.tm_sec == another._time.tm_sec)
-							return 0; // equal
-					}
-				}
-			}
-		}
-	}
+void TimeStamp::assign(int year, int mon, int mday, int hour, int min, int sec, int usec)
+{
+    // months out of [1..12] move the year, the rest is linear
+    int monIndex = mon - 1;
+    int yearShift = monIndex >= 0 ? monIndex / 12 : (monIndex - 11) / 12;
+    monIndex -= yearShift * 12;
 
-	return -1;
+    std::int64_t days = daysFromCivil(std::int64_t(year) + yearShift, monIndex + 1, 1)
+            + (mday - 1);
 
-   // Красиво, правда?
+    std::int64_t seconds = days * 86400 + std::int64_t(hour) * 3600 + std::int64_t(min) * 60 + sec;
+    _micros = seconds * MICROS_PER_SEC + usec;
 }
 
 //-----------------------------------------------------------------------------
 
-void TimeStamp::normalize()
+std::int64_t TimeStamp::daysFromCivil(std::int64_t year, int mon, int mday)
 {
-    _time.tm_isdst = -1;
-    time_t tTime = mktime(&_time);
-    _time = *localtime(&tTime);
+    // H. Hinnant's algorithm: years start in March, so the leap day is the
+    // last day of a year; eras are 400-year cycles of 146097 days
+    year -= mon <= 2;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    std::int64_t yoe = year - era * 400;                                // [0, 399]
+    std::int64_t doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+    std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;           // [0, 146096]
+
+    return era * 146097 + doe - 719468;
 }
 
 //-----------------------------------------------------------------------------
 
-std::istream& operator>>(std::istream& in, TimeStamp& tsInput)
+void TimeStamp::civilFromDays(std::int64_t days, std::int64_t& year, int& mon, int& mday)
+{
+    std::int64_t z = days + 719468;
+    std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    std::int64_t doe = z - era * 146097;
+    std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    std::int64_t mp = (5 * doy + 2) / 153;
+
+    mon = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    mday = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    year = yoe + era * 400 + (mon <= 2);
+}
+
+//-----------------------------------------------------------------------------
+
+struct tm TimeStamp::toTm() const
 {
-	char tmp;
-	do
-	{
-        in >> tsInput._time.tm_year;
-        if (!in)
-            break;
+    std::int64_t seconds = getSeconds();
+    std::int64_t days = floorDiv(seconds, 86400);
+    std::int64_t secOfDay = seconds - days * 86400;
+
+    std::int64_t year;
+    int mon, mday;
+    civilFromDays(days, year, mon, mday);
+
+    struct tm result = tm();
+    result.tm_year = static_cast<int>(year - 1900);
+    result.tm_mon  = mon - 1;
+    result.tm_mday = mday;
+    result.tm_hour = static_cast<int>(secOfDay / 3600);
+    result.tm_min  = static_cast<int>(secOfDay / 60 % 60);
+    result.tm_sec  = static_cast<int>(secOfDay % 60);
+    result.tm_isdst = -1;
+
+    return result;
+}
 
-        tsInput._time.tm_year -= 1900;
-		in >> tmp; // skip .
-        if (!in)
-            break;
+//-----------------------------------------------------------------------------
 
-        in >> tsInput._time.tm_mon;
-        // because tm_mon should be between 0 and 11!!!!!!
-        tsInput._time.tm_mon -= 1;
-        if (!in)
-            break;
+char* TimeStamp::format(char* buf) const
+{
+    std::int64_t seconds = getSeconds();
+    std::int64_t days = floorDiv(seconds, 86400);
 
-		in >> tmp; // skip .
-        if (!in)
-            break;
+    formatDate(days, buf);
+    buf[10] = ' ';
+    formatTime(static_cast<int>(seconds - days * 86400), buf + 11);
 
-        in >> tsInput._time.tm_mday;
-        if (!in)
-            break;
+    return formatFraction(static_cast<int>(_micros - seconds * MICROS_PER_SEC),
+                          buf + SIZE_STRTIME);
+}
 
-        in >> std::ws;                  // skip whitespaces (кто бы думал!)
-        if (!in)
-            break;
+//-----------------------------------------------------------------------------
 
-        in >> tsInput._time.tm_hour;
-        if (!in)
-            break;
+void TimeStamp::formatDate(std::int64_t days, char* buf)
+{
+    std::int64_t year;
+    int mon, mday;
+    civilFromDays(days, year, mon, mday);
+
+    writeDigits(buf, static_cast<int>(year), 4);
+    buf[4] = '.';
+    writeDigits(buf + 5, mon, 2);
+    buf[7] = '.';
+    writeDigits(buf + 8, mday, 2);
+}
 
-		in >> tmp; // skip :
-        if (!in)
-            break;
+//-----------------------------------------------------------------------------
 
-        in >> tsInput._time.tm_min;
-        if (!in)
-            break;
+void TimeStamp::formatTime(int secOfDay, char* buf)
+{
+    writeDigits(buf, secOfDay / 3600, 2);
+    buf[2] = ':';
+    writeDigits(buf + 3, secOfDay / 60 % 60, 2);
+    buf[5] = ':';
+    writeDigits(buf + 6, secOfDay % 60, 2);
+}
 
-		in >> tmp; // skip :
-        if (!in)
-            break;
+//-----------------------------------------------------------------------------
 
-        in >> tsInput._time.tm_sec;
-        if (!in)
-            break;
+char* TimeStamp::formatFraction(int usec, char* buf)
+{
+    if (usec == 0)
+        return buf;
+
+    *buf++ = '.';
+    if (usec % 1000 == 0)
+    {
+        writeDigits(buf, usec / 1000, 3);
+        return buf + 3;
+    }
+
+    writeDigits(buf, usec, 6);
+    return buf + 6;
+}
 
-		tsInput.normalize();
-	} while (false);
+//-----------------------------------------------------------------------------
 
-	return in;
+std::istream& operator>>(std::istream& in, TimeStamp& tsInput)
+{
+    char tmp;
+    int year, mon, mday, hour, min, sec;
+
+    // the stamp is changed only if all the components are read
+    in >> year >> tmp >> mon >> tmp >> mday        // 2015.06.17
+       >> std::ws
+       >> hour >> tmp >> min >> tmp >> sec;        // 10:33:03
+
+    // optional fraction: .123456; a stamp at the end of the stream has none,
+    // and peek() would set failbit there
+    int usec = 0;
+    if (in && !in.eof() && in.peek() == '.')
+    {
+        char digits[16];
+        size_t count = 0;
+
+        in.get();
+        while (count < sizeof(digits) && isdigit(in.peek()))
+            digits[count++] = static_cast<char>(in.get());
+
+        if (TimeStamp::parseFraction(digits, digits + count, usec) != digits + count)
+            in.setstate(std::ios::failbit);
+    }
+
+    if (in)
+        tsInput.assign(year, mon, mday, hour, min, sec, usec);
+
+    return in;
 }
 
 //-----------------------------------------------------------------------------
@@ -154,10 +277,55 @@ std::istream& operator>>(std::istream& in, TimeStamp& tsInput)
 std::ostream& operator<<(std::ostream& out, const TimeStamp& tsOutput)
 {
     char buf[TimeStamp::SIZE_MAXSTRTIME];
+    out.write(buf, tsOutput.format(buf) - buf);
+
+    return out;
+}
 
-    // вызов этой функции небезопасен, но она относится к базовому блоку C-функций
-    strftime(buf, TimeStamp::SIZE_MAXSTRTIME, "%Y.%m.%d %H:%M:%S", &tsOutput._time);
-	out << buf;
 
-	return out;
+//==============================================================================
+// class TimeStampFormatter
+//==============================================================================
+
+TimeStampFormatter::TimeStampFormatter()
+    : _cached(false)
+    , _seconds(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+char* TimeStampFormatter::format(const TimeStamp& ts, char* buf)
+{
+    std::int64_t seconds = ts.getSeconds();
+
+    if (!_cached)
+    {
+        ts.format(_text);
+    }
+    else if (seconds != _seconds)
+    {
+        std::int64_t days = floorDiv(seconds, 86400);
+        int secOfDay = static_cast<int>(seconds - days * 86400);
+
+        if (floorDiv(seconds, 60) == floorDiv(_seconds, 60))
+        {
+            writeDigits(_text + 17, secOfDay % 60, 2);
+        }
+        else
+        {
+            if (days != floorDiv(_seconds, 86400))
+                TimeStamp::formatDate(days, _text);
+
+            TimeStamp::formatTime(secOfDay, _text + 11);
+        }
+    }
+
+    _cached = true;
+    _seconds = seconds;
+
+    std::memcpy(buf, _text, TimeStamp::SIZE_STRTIME);
+    return TimeStamp::formatFraction(
+                static_cast<int>(ts._micros - seconds * TimeStamp::MICROS_PER_SEC),
+                buf + TimeStamp::SIZE_STRTIME);
 }
@@ -1,6 +1,7 @@
 ﻿////////////////////////////////////////////////////////////////////////////////
 /// \file
-/// \brief      Contains interface part of Timestamp class.
+/// \brief      Contains interface part of Timestamp and TimeStampFormatter
+///             classes.
 ///
 /// \author     Leonid W. Dworzanski <leo@mathtech.ru> © 2014–2016.
 /// \author     Sergey A. Shershakov <sshershakov@hse.ru> © 2015–2018.
@@ -20,64 +21,113 @@
 
 #include <iostream>
 #include <ctime>
+#include <cstdint>
+
+#include "key_prefix.h"
 
 //using namespace std;
 
 /*! ****************************************************************************
  *  \brief Используется для представления временного штампа «дата+время».
+ *
+ *  The stamp is a single number of microseconds since 1970.01.01 00:00:00
+ *  of the same (local) clock the stamp is written in, with no time zone or
+ *  DST adjustments, so comparisons are plain integer ones.
+ *
+ *  In the text form the fraction of a second is optional:
+ *  2015.06.17 10:33:03 or 2015.06.17 10:33:03.123456
  ******************************************************************************/
 class TimeStamp
 {
 public:
     // Constants
 
-    /// 22 is the maximum length of such timestamps (да, 22!).
-    static const size_t SIZE_MAXSTRTIME = 25;
+    /// 26 is the maximum length of such timestamps (да, 26!).
+    static const size_t SIZE_MAXSTRTIME = 32;
+
+    /// Length of a timestamp in the fixed format with no fraction:
+    /// 2015.06.17 10:33:03
+    static const size_t SIZE_STRTIME = 19;
+
+    /// Number of microseconds in a second.
+    static const std::int64_t MICROS_PER_SEC = 1000000;
 public:
     /// Default constructor.
     TimeStamp();
 
     /// Initialize with date components.
-	TimeStamp(int year, int mon = 1, int mday = 1, int hour = 0, int min = 0, int sec = 0);
+	TimeStamp(int year, int mon = 1, int mday = 1, int hour = 0, int min = 0, int sec = 0,
+              int usec = 0);
 
     /// Checks if timestamps are equal.
     bool operator== (const TimeStamp& another) const
     {
-        return (compareTo(another) == 0);
+        return _micros == another._micros;
     }
 
     /// Checks if timestamps are not equal.
     bool operator!= (const TimeStamp& another) const
     {
-        return compareTo(another) != 0;
+        return _micros != another._micros;
     }
 
     /// Checks if left timestamp is earlier than the right one.
     bool operator< (const TimeStamp& another) const
     {
-        return (compareTo(another) == -1);
+        return _micros < another._micros;
     }
 
     /// Checks if left timestamp is earlier than or equal to the right one.
     bool operator<= (const TimeStamp& another) const
     {
-        int compare = compareTo(another);
-        return (compare == 0 || compare == -1);
+        return _micros <= another._micros;
     }
 
     bool operator>= (const TimeStamp& another) const
     {
-        return !operator<(another);
+        return _micros >= another._micros;
     }
 
     bool operator> (const TimeStamp& another) const
     {
-        return !operator<=(another);
+        return _micros > another._micros;
     }
 
+    /// Returns the number of whole seconds since 1970.01.01 00:00:00.
+    std::int64_t getSeconds() const;
+
+    /// Returns the number of microseconds since 1970.01.01 00:00:00.
+    std::int64_t getMicroseconds() const { return _micros; }
+
+    /// \brief Reads the stamp in the fixed format 2015.06.17 10:33:03 from
+    /// the characters [\a begin, \a end).
+    ///
+    /// Every field must have all its digits, no spaces are skipped. The
+    /// seconds may be followed by a fraction of 1 to 9 digits, digits
+    /// beyond microseconds are dropped. Unlike operator>>, works with no
+    /// stream and no locale.
+    /// \return the position right after the stamp, or nullptr if the
+    /// characters are not a stamp; the stamp is not changed then.
+    const char* parse(const char* begin, const char* end);
+
+    /// \brief Writes the stamp in the format 2015.06.17 10:33:03 to \a buf
+    /// with no terminating zero.
+    ///
+    /// A nonzero fraction of a second is written as milliseconds if it is a
+    /// whole number of them, and as microseconds otherwise.
+    ///
+    /// \a buf must have room for SIZE_MAXSTRTIME characters. Years must be
+    /// in [0..9999].
+    /// \return the position right after the written stamp.
+    char* format(char* buf) const;
+
+    /// Converts the stamp to date components; fields other than date and
+    /// time (week day, DST flag, etc.) are not filled.
+    struct tm toTm() const;
+
 public:
     /// \brief \a operator>> Reads timestamp from the input stream \a in.
-    /// The format is: 2015.06.17 10:33:03
+    /// The format is: 2015.06.17 10:33:03 with an optional fraction.
     friend std::istream &operator>>(std::istream& in, TimeStamp& tsInput);
 
     /// \brief \a operator<< Puts timestamp to the output stream out
@@ -92,15 +142,93 @@ protected:
      *  \return 0 if two timestamps are equal to each other, 1 if this > anothers,
      *      -1  --  this < another.
      */
-    int compareTo(const TimeStamp& another) const;
+    int compareTo(const TimeStamp& another) const
+    {
+        return (_micros > another._micros) - (_micros < another._micros);
+    }
+
+    /// \brief Sets the stamp from date components.
+    ///
+    /// Components out of their ranges are normalized like mktime() does,
+    /// e.g. 61 seconds are a minute and a second.
+    void assign(int year, int mon, int mday, int hour, int min, int sec, int usec = 0);
+
+    /// \brief Reads a fraction of a second: 1 to 9 digits at \a pos.
+    /// \return the position right after the digits, or nullptr if there
+    /// are none; \a usec is set to the number of microseconds.
+    static const char* parseFraction(const char* pos, const char* end, int& usec);
 
-    /// Structure "struct tm" normalization fills "week day" and similiar fields.
-    /// This is needed for correct work of other <ctime> functions.
-    void normalize();
+    /// Writes ".mmm" or ".uuuuuu" for a nonzero \a usec, nothing for zero.
+    /// \return the position right after the written fraction.
+    static char* formatFraction(int usec, char* buf);
+
+    /// Number of days from 1970.01.01 to the given date of the proleptic
+    /// Gregorian calendar, \a mon is in [1..12].
+    static std::int64_t daysFromCivil(std::int64_t year, int mon, int mday);
+
+    /// Inverse of daysFromCivil().
+    static void civilFromDays(std::int64_t days, std::int64_t& year, int& mon, int& mday);
+
+    /// Writes "YYYY.MM.DD" for the given number of days since 1970.01.01.
+    static void formatDate(std::int64_t days, char* buf);
+
+    /// Writes "HH:MM:SS" for the given number of seconds since midnight.
+    static void formatTime(int secOfDay, char* buf);
+
+    friend class TimeStampFormatter;
 
 protected:
-    /// struct tm - internal structure of <ctime> library.
-    struct tm _time;
+    /// Microseconds since 1970.01.01 00:00:00.
+    std::int64_t _micros;
 }; // class TimeStamp
 
+//==============================================================================
+
+
+/// Stamps are whole microseconds, so their prefixes are exact.
+template <>
+struct KeyPrefix<TimeStamp>
+{
+    static const bool exact = true;
+
+    static std::uint64_t get(const TimeStamp& key)
+    {
+        return static_cast<std::uint64_t>(key.getMicroseconds()) ^ (std::uint64_t(1) << 63);
+    }
+};
+
+//==============================================================================
+
+
+
+/*! ****************************************************************************
+ *  \brief Writes many timestamps in a row, like rows of a journal.
+ *
+ *  Neighbour rows of a log mostly have the same date and often the same
+ *  second, so the formatter keeps the text of the last stamp and renders
+ *  only the parts that differ: nothing for the same second, the seconds
+ *  for the same minute, the time for the same day. The fraction of a
+ *  second is written every time.
+ ******************************************************************************/
+class TimeStampFormatter
+{
+public:
+    /// Default constructor: nothing is cached.
+    TimeStampFormatter();
+
+    /// \brief Writes \a ts like TimeStamp::format() does.
+    /// \return the position right after the written stamp.
+    char* format(const TimeStamp& ts, char* buf);
+
+protected:
+    /// Whether _text holds a rendered stamp.
+    bool _cached;
+
+    /// Whole seconds of the cached stamp.
+    std::int64_t _seconds;
+
+    /// Text of the cached stamp with no fraction.
+    char _text[TimeStamp::SIZE_MAXSTRTIME];
+}; // class TimeStampFormatter
+
 #endif // CYBERPOLICE_TIME_STAMP_H_
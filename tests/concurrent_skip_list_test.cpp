@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for ConcurrentSkipList class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "concurrent_skip_list.h"
+#include "skip_list.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef ConcurrentSkipList<int, int, 10> TestConcurrentList;
+
+/// Returns the number of nodes on the dense level and checks that every
+/// level is ordered.
+static int checkLevels(const TestConcurrentList& list)
+{
+    TestConcurrentList::Node* preHead = list.getPreHead();
+    for (int level = 9; level >= -1; --level)
+    {
+        TestConcurrentList::Node* run = reinterpret_cast<TestConcurrentList::Node*>(
+                    preHead->link(level).load() & ~TestConcurrentList::Node::MARK);
+        while (run != preHead)
+        {
+            TestConcurrentList::Node* next = reinterpret_cast<TestConcurrentList::Node*>(
+                        run->link(level).load() & ~TestConcurrentList::Node::MARK);
+            if (next != preHead)
+            {
+                EXPECT_FALSE(next->key < run->key) << "level " << level;
+            }
+            run = next;
+        }
+    }
+
+    int count = 0;
+    for (TestConcurrentList::Node* run = preHead->getNext(); run != preHead; run = run->getNext())
+        ++count;
+
+    return count;
+}
+
+
+TEST(ConcurrentSkipList, sequentialLikeSkipList)
+{
+    ConcurrentSkipList<string, int, 10> list;
+
+    list.insert("one1", 1);
+    list.insert("three1", 3);
+    list.insert("one2", 1);
+    list.insert("four1", 4);
+    list.insert("three2", 3);
+
+    ConcurrentSkipList<string, int, 10>::Node* node = list.findFirst(1);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->value, "one1");
+    EXPECT_EQ(node->getNext()->value, "one2");
+    EXPECT_EQ(list.findFirst(3)->value, "three1");
+    EXPECT_EQ(list.findFirst(2), nullptr);
+    EXPECT_EQ(list.findLastLessThan(1), list.getPreHead());
+    EXPECT_EQ(list.findLastLessThan(3)->value, "one2");
+
+    EXPECT_TRUE(list.removeNext(list.findLastLessThan(3)));
+    EXPECT_EQ(list.findFirst(3)->value, "three2");
+
+    EXPECT_THROW(list.removeNext(nullptr), invalid_argument);
+    EXPECT_THROW(list.removeNext(list.findLastLessThan(100)), invalid_argument);
+}
+
+TEST(ConcurrentSkipList, seededLikeSkipList)
+{
+    // a single thread gets the heights a SkipList with the seed would, also
+    // when it inserts into another list in turn
+    TestConcurrentList list(0.5, 42);
+    TestConcurrentList other(0.5, 43);
+    SkipList<int, int, 10> reference(0.5, 42);
+
+    for (int i = 0; i < 500; ++i)
+    {
+        list.insert(i, i);
+        other.insert(i, i);
+        reference.insert(i, i);
+    }
+
+    int sameAsOther = 0;
+    TestConcurrentList::Node* run = list.getPreHead()->getNext();
+    TestConcurrentList::Node* runOther = other.getPreHead()->getNext();
+    SkipList<int, int, 10>::Node* runReference = reference.getPreHead()->next;
+    for (int i = 0; i < 500; ++i)
+    {
+        ASSERT_EQ(run->levelHighest, runReference->levelHighest) << i;
+        sameAsOther += run->levelHighest == runOther->levelHighest;
+
+        run = run->getNext();
+        runOther = runOther->getNext();
+        runReference = runReference->next;
+    }
+
+    EXPECT_LT(sameAsOther, 500);
+}
+
+TEST(ConcurrentSkipList, parallelInsert)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 5000;
+
+    TestConcurrentList list;
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.push_back(thread([&list, t]()
+        {
+            for (int i = 0; i < PER_THREAD; ++i)
+                list.insert(t, (i * 7919 + t) % 1000);
+        }));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    EXPECT_EQ(checkLevels(list), THREADS * PER_THREAD);
+    for (int key = 0; key < 1000; ++key)
+        EXPECT_NE(list.findFirst(key), nullptr);
+}
+
+TEST(ConcurrentSkipList, parallelInsertAndRemove)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 5000;
+
+    TestConcurrentList list;
+    atomic<int> removed(0);
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.push_back(thread([&list, &removed, t]()
+        {
+            for (int i = 0; i < PER_THREAD; ++i)
+            {
+                int key = (i * 7919 + t) % 1000;
+                list.insert(t, key);
+
+                if (i % 2 == 0)
+                {
+                    TestConcurrentList::Guard guard;
+                    try
+                    {
+                        if (list.removeNext(list.findLastLessThan(key)))
+                            ++removed;
+                    }
+                    catch (invalid_argument&)
+                    {
+                        // the tail has been removed by another thread
+                    }
+                }
+            }
+        }));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    EXPECT_GT(removed.load(), 0);
+    EXPECT_EQ(checkLevels(list), THREADS * PER_THREAD - removed.load());
+    EpochReclaimer::instance().collect();
+}
@@ -21,6 +21,13 @@
 
 #include "time_stamp.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
 using namespace std;
 
 stringstream getLog1()
@@ -82,3 +89,302 @@ TEST(Journal, log1_emaxx)
 
 
 
+
+TEST(Journal, mappedLog)
+{
+    JournalNetActivity<5> mapped;
+    mapped.parseLog(DATA_DIR "test2.log");
+
+    JournalNetActivity<5> streamed;
+    ifstream fin(DATA_DIR "test2.log");
+    streamed.parseLogFromStream(fin);
+
+    stringstream mappedDump, streamedDump;
+    mapped.dumpJournal(mappedDump);
+    streamed.dumpJournal(streamedDump);
+    EXPECT_FALSE(mappedDump.str().empty());
+    EXPECT_EQ(mappedDump.str(), streamedDump.str());
+
+    EXPECT_THROW(mapped.parseLog(DATA_DIR "no_such.log"), logic_error);
+}
+
+TEST(Journal, bufferLog)
+{
+    // CRLF ends, a blank line, a loose line and no final line end
+    const string text = "2015.06.10 10:33:02 user126 e-maxx.ru\r\n"
+                        "\r\n"
+                        "2015.06.10   10:33:03 user127 e-maxx.ru\n"
+                        "2015.06.10 10:33:04 user128 e-maxx.ru";
+
+    JournalNetActivity<5> journal;
+    journal.parseLogFromBuffer(text.data(), text.size());
+
+    stringstream output;
+    journal.outputSuspiciousActivities("e-maxx.ru", TimeStamp(2015, 6, 10, 10, 33, 0),
+                                       TimeStamp(2015, 6, 10, 10, 34, 0), output);
+    EXPECT_EQ(output.str(), "2015.06.10 10:33:02 user126 e-maxx.ru\n"
+                            "2015.06.10 10:33:03 user127 e-maxx.ru\n"
+                            "2015.06.10 10:33:04 user128 e-maxx.ru\n");
+}
+
+TEST(Journal, parallelLog)
+{
+    // out of order and equal stamps, loose lines, blank lines; enough text
+    // for several chunks
+    srand(7);
+    string text;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int second = i / 10 + rand() % 50;
+        stringstream stamp;
+        stamp << TimeStamp(2015, 6, 10, 10, 0, second);
+        string stampText = stamp.str();
+        if (i % 97 == 0)
+            stampText.insert(10, "  ");
+
+        stringstream line;
+        line << stampText << " user" << rand() % 40
+             << " host" << rand() % 15 << ".ru" << (i % 101 == 0 ? "\r\n\n" : "\n");
+        text += line.str();
+    }
+
+    JournalNetActivity<5> sequential;
+    sequential.parseLogFromBuffer(text.data(), text.size());
+
+    stringstream expected;
+    sequential.dumpJournal(expected);
+
+    const unsigned threadCounts[] = {0, 2, 3, 8};
+    for (int t = 0; t < 4; ++t)
+    {
+        JournalNetActivity<5> parallel;
+        parallel.parseLogFromBuffer(text.data(), text.size(), threadCounts[t]);
+
+        stringstream dump;
+        parallel.dumpJournal(dump);
+        ASSERT_EQ(dump.str(), expected.str()) << threadCounts[t] << " threads";
+
+        stringstream hostOutput, expectedHostOutput;
+        parallel.outputSuspiciousActivities("host3.ru", TimeStamp(2015, 6, 10, 10, 5, 0),
+                                            TimeStamp(2015, 6, 10, 10, 20, 0), hostOutput);
+        sequential.outputSuspiciousActivities("host3.ru", TimeStamp(2015, 6, 10, 10, 5, 0),
+                                              TimeStamp(2015, 6, 10, 10, 20, 0), expectedHostOutput);
+        EXPECT_FALSE(hostOutput.str().empty());
+        EXPECT_EQ(hostOutput.str(), expectedHostOutput.str());
+
+        stringstream userOutput, expectedUserOutput;
+        parallel.outputUserActivities("user11", TimeStamp(2015, 6, 10, 10, 0, 0),
+                                      TimeStamp(2015, 6, 10, 11, 0, 0), userOutput);
+        sequential.outputUserActivities("user11", TimeStamp(2015, 6, 10, 10, 0, 0),
+                                        TimeStamp(2015, 6, 10, 11, 0, 0), expectedUserOutput);
+        EXPECT_EQ(userOutput.str(), expectedUserOutput.str());
+    }
+}
+
+TEST(Journal, outOfOrderLog)
+{
+    stringstream log(
+            "2015.06.10 10:33:02 a e-maxx.ru\n"
+            "2015.06.10 10:33:03 b e-maxx.ru\n"
+            "2015.06.10 10:33:01 c e-maxx.ru\n"
+            "2015.06.10 10:33:02 d e-maxx.ru\n"
+            "2015.06.10 10:33:04 e e-maxx.ru\n"
+            "2015.06.10 10:33:04 f e-maxx.ru\n"
+    );
+
+    JournalNetActivity<5> journal;
+    journal.parseLogFromStream(log);
+
+    stringstream output;
+    journal.outputSuspiciousActivities("e-maxx.ru", TimeStamp(2015, 6, 10, 10, 33, 1),
+                                       TimeStamp(2015, 6, 10, 10, 33, 4), output);
+    EXPECT_EQ(output.str(), "2015.06.10 10:33:01 c e-maxx.ru\n"
+                            "2015.06.10 10:33:02 a e-maxx.ru\n"
+                            "2015.06.10 10:33:02 d e-maxx.ru\n"
+                            "2015.06.10 10:33:03 b e-maxx.ru\n"
+                            "2015.06.10 10:33:04 e e-maxx.ru\n"
+                            "2015.06.10 10:33:04 f e-maxx.ru\n");
+}
+
+TEST(Journal, looseFormatLog)
+{
+    // blank lines, unpadded stamps and extra spaces are still accepted
+    stringstream log(
+            "  2015.06.10 10:33:01   a    e-maxx.ru  \n"
+            "\n"
+            "2015.6.10 10:33:2 b e-maxx.ru\n"
+            "2015.06.10 10:33:03 broken\n"
+            "2015.06.10\t10:33:04\tc\te-maxx.ru\n"
+    );
+
+    JournalNetActivity<5> journal;
+    journal.parseLogFromStream(log);
+
+    stringstream output;
+    journal.outputSuspiciousActivities("e-maxx.ru", TimeStamp(2015, 6, 10, 10, 33, 1),
+                                       TimeStamp(2015, 6, 10, 10, 33, 4), output);
+    EXPECT_EQ(output.str(), "2015.06.10 10:33:01 a e-maxx.ru\n"
+                            "2015.06.10 10:33:02 b e-maxx.ru\n"
+                            "2015.06.10 10:33:04 c e-maxx.ru\n");
+}
+
+TEST(Journal, subSecondLog)
+{
+    stringstream log(
+            "2015.06.10 10:33:01.250 a e-maxx.ru\n"
+            "2015.06.10 10:33:01.000100 b e-maxx.ru\n"
+            "2015.06.10 10:33:01 c e-maxx.ru\n"
+            "2015.06.10 10:33:01.75 d e-maxx.ru\n"
+            "2015.06.10 10:33:02.5 e e-maxx.ru\n"
+    );
+
+    JournalNetActivity<5> journal;
+    journal.parseLogFromStream(log);
+
+    stringstream output;
+    journal.outputSuspiciousActivities("e-maxx.ru", TimeStamp(2015, 6, 10, 10, 33, 1, 100),
+                                       TimeStamp(2015, 6, 10, 10, 33, 1, 750000), output);
+    EXPECT_EQ(output.str(), "2015.06.10 10:33:01.000100 b e-maxx.ru\n"
+                            "2015.06.10 10:33:01.250 a e-maxx.ru\n"
+                            "2015.06.10 10:33:01.750 d e-maxx.ru\n");
+}
+
+/// Record of a generated log, for the brute-force answers.
+struct LogRecord
+{
+    int second;
+    string user;
+    string host;
+};
+
+/// Orders records by time only: stable sort keeps the order of the log.
+static bool earlierRecord(const LogRecord& a, const LogRecord& b)
+{
+    return a.second < b.second;
+}
+
+TEST(Journal, indicesMatchScan)
+{
+    vector<LogRecord> records;
+    stringstream log;
+
+    srand(3);
+    for (int i = 0; i < 3000; ++i)
+    {
+        // mostly ordered, with repeating and jumping back seconds
+        LogRecord record;
+        record.second = i / 4 + (rand() % 10 == 0 ? -(rand() % 30) : 0);
+        if (record.second < 0)
+            record.second = 0;
+        record.user = "user" + to_string(rand() % 50);
+        record.host = "host" + to_string(rand() % 20) + ".ru";
+        records.push_back(record);
+
+        log << "2015.06.10 10:" << (10 + record.second / 60) << ":"
+            << (record.second % 60 < 10 ? "0" : "") << record.second % 60
+            << " " << record.user << " " << record.host << "\n";
+    }
+
+    JournalNetActivity<5> journal;
+    journal.parseLogFromStream(log);
+
+    stable_sort(records.begin(), records.end(), earlierRecord);
+
+    const int ranges[][2] = {{0, 749}, {100, 100}, {10, 300}, {700, 800}};
+    for (int host = 0; host < 21; ++host)
+        for (int r = 0; r < 4; ++r)
+        {
+            string hostName = "host" + to_string(host) + ".ru";
+            int from = ranges[r][0], to = ranges[r][1];
+
+            stringstream expected;
+            for (size_t i = 0; i < records.size(); ++i)
+                if (records[i].host == hostName && from <= records[i].second && records[i].second <= to)
+                    expected << TimeStamp(2015, 6, 10, 10, 10, records[i].second)
+                             << " " << records[i].user << " " << hostName << endl;
+
+            stringstream output;
+            journal.outputSuspiciousActivities(hostName, TimeStamp(2015, 6, 10, 10, 10, from),
+                                               TimeStamp(2015, 6, 10, 10, 10, to), output);
+            ASSERT_EQ(output.str(), expected.str()) << hostName << " " << from << ".." << to;
+
+            // the buffered output is the same text
+            string buffered;
+            journal.outputSuspiciousActivities(hostName, TimeStamp(2015, 6, 10, 10, 10, from),
+                                               TimeStamp(2015, 6, 10, 10, 10, to),
+                                               [&buffered](const char* data, size_t size)
+                                               { buffered.append(data, size); });
+            ASSERT_EQ(buffered, expected.str()) << hostName << " " << from << ".." << to;
+        }
+
+    for (int user = 0; user < 51; ++user)
+        for (int r = 0; r < 4; ++r)
+        {
+            string userName = "user" + to_string(user);
+            int from = ranges[r][0], to = ranges[r][1];
+
+            stringstream expected;
+            for (size_t i = 0; i < records.size(); ++i)
+                if (records[i].user == userName && from <= records[i].second && records[i].second <= to)
+                    expected << TimeStamp(2015, 6, 10, 10, 10, records[i].second)
+                             << " " << userName << " " << records[i].host << endl;
+
+            stringstream output;
+            journal.outputUserActivities(userName, TimeStamp(2015, 6, 10, 10, 10, from),
+                                         TimeStamp(2015, 6, 10, 10, 10, to), output);
+            ASSERT_EQ(output.str(), expected.str()) << userName << " " << from << ".." << to;
+
+            stringstream buffered;
+            journal.outputUserActivities(userName, TimeStamp(2015, 6, 10, 10, 10, from),
+                                         TimeStamp(2015, 6, 10, 10, 10, to),
+                                         OutputBuffer::streamSink(buffered));
+            ASSERT_EQ(buffered.str(), expected.str()) << userName << " " << from << ".." << to;
+        }
+
+    stringstream output;
+    EXPECT_THROW(journal.outputUserActivities("user1", TimeStamp(2015, 6, 10, 10, 10, 2),
+                                              TimeStamp(2015, 6, 10, 10, 10, 1), output),
+                 invalid_argument);
+}
+
+TEST(Journal, reversedLog)
+{
+    // every record is late: the indices are sorted after parsing, records
+    // with equal stamps keep the order of the log
+    stringstream log;
+    vector<string> lines;
+    for (int second = 599; second >= 0; --second)
+        for (int k = 0; k < 3; ++k)
+        {
+            stringstream line;
+            line << TimeStamp(2015, 6, 10, 10, 10, second) << " user" << k
+                 << " host" << (second + k) % 2 << ".ru";
+            log << line.str() << "\n";
+            lines.push_back(line.str());
+        }
+
+    string text = log.str();
+    JournalNetActivity<5> journal;
+    journal.parseLogFromBuffer(text.data(), text.size());
+
+    stringstream expectedHost, expectedUser;
+    for (int second = 0; second < 600; ++second)
+        for (int k = 0; k < 3; ++k)
+        {
+            const string& line = lines[(599 - second) * 3 + k];
+            if ((second + k) % 2 == 1)
+                expectedHost << line << endl;
+            if (k == 2)
+                expectedUser << line << endl;
+        }
+
+    stringstream output;
+    journal.outputSuspiciousActivities("host1.ru", TimeStamp(2015, 6, 10, 10, 10, 0),
+                                       TimeStamp(2015, 6, 10, 10, 20, 0), output);
+    EXPECT_EQ(output.str(), expectedHost.str());
+
+    output.str("");
+    journal.outputUserActivities("user2", TimeStamp(2015, 6, 10, 10, 10, 0),
+                                 TimeStamp(2015, 6, 10, 10, 20, 0), output);
+    EXPECT_EQ(output.str(), expectedUser.str());
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for LogGenerator class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "log_generator.h"
+#include "journal_net_activity.h"
+
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+
+TEST(LogGenerator, format)
+{
+    LogGenerator::Options options;
+    options.lines = 5;
+    options.users = 3;
+    options.hosts = 2;
+    options.rate = 2;
+    options.userWidth = 8;
+    options.start = TimeStamp(2015, 6, 10, 23, 59, 58);
+
+    string text = LogGenerator(options).generateText();
+
+    // stamps go at the rate and over midnight; users are aligned
+    istringstream lines(text);
+    string line;
+    const char* STAMPS[] = { "2015.06.10 23:59:58", "2015.06.10 23:59:58",
+                             "2015.06.10 23:59:59", "2015.06.10 23:59:59",
+                             "2015.06.11 00:00:00" };
+    for (int i = 0; i < 5; ++i)
+    {
+        ASSERT_TRUE(getline(lines, line));
+        EXPECT_EQ(line.substr(0, 19), STAMPS[i]);
+        EXPECT_EQ(line.substr(19, 5), "    u");
+        EXPECT_EQ(line.substr(line.size() - 3), ".ru");
+    }
+    EXPECT_FALSE(getline(lines, line));
+
+    // the same options, the same log
+    EXPECT_EQ(LogGenerator(options).generateText(), text);
+
+    options.seed = 7;
+    EXPECT_NE(LogGenerator(options).generateText(), text);
+
+    options.users = 0;
+    EXPECT_THROW(LogGenerator generator(options), invalid_argument);
+}
+
+TEST(LogGenerator, distribution)
+{
+    LogGenerator::Options options;
+    options.lines = 20000;
+    options.hosts = 10;
+    options.disorder = 0.1;
+    options.maxDelay = 3;
+
+    string text = LogGenerator(options).generateText();
+
+    map<string, int> hostCounts;
+    istringstream lines(text);
+    TimeStamp stamp, last(1970);
+    string user, host;
+    int delayed = 0;
+    int records = 0;
+    while (lines >> stamp >> user >> host)
+    {
+        ++hostCounts[host];
+        delayed += stamp < last;
+        last = stamp;
+        ++records;
+    }
+    EXPECT_EQ(records, 20000);
+
+    // 1/k popularity: the first host is about twice as popular as the
+    // second one and ten times as the last one
+    EXPECT_NEAR(hostCounts["host0.ru"] / double(hostCounts["host1.ru"]), 2.0, 0.2);
+    EXPECT_NEAR(hostCounts["host0.ru"] / double(hostCounts["host9.ru"]), 10.0, 2.0);
+
+    // some delayed records go before their predecessors
+    EXPECT_GT(delayed, 1000);
+    EXPECT_LT(delayed, 2000);
+
+    // the journal reads all of them
+    JournalNetActivity<5> journal;
+    journal.parseLogFromBuffer(text.data(), text.size());
+    stringstream dump;
+    journal.dumpJournal(dump);
+    EXPECT_EQ(dump.str().size(), text.size() - records);       // with no line ends
+}
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for LogTokenizer class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "log_tokenizer.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/// Runs a test body for every instruction set the CPU supports.
+class IsaSwitch
+{
+public:
+    IsaSwitch() : _saved(LogTokenizer::getIsa()) {}
+    ~IsaSwitch() { LogTokenizer::setIsa(_saved); }
+
+    /// Supported instruction sets.
+    static vector<LogTokenizer::Isa> supported()
+    {
+        vector<LogTokenizer::Isa> isas;
+        for (int isa = LogTokenizer::ISA_SCALAR; isa <= LogTokenizer::getBestIsa(); ++isa)
+            isas.push_back(static_cast<LogTokenizer::Isa>(isa));
+        return isas;
+    }
+
+private:
+    LogTokenizer::Isa _saved;
+};
+
+
+/// Tokenized by a static initializer, before main() and maybe before the
+/// tokenizer's own translation unit is initialized.
+static const char STATIC_INIT_TEXT[] = "  alice host";
+static const char* const STATIC_INIT_WORD =
+        LogTokenizer::skipSpaces(STATIC_INIT_TEXT, STATIC_INIT_TEXT + sizeof(STATIC_INIT_TEXT) - 1);
+
+
+TEST(LogTokenizer, staticInitialization)
+{
+    EXPECT_EQ(STATIC_INIT_WORD, STATIC_INIT_TEXT + 2);
+}
+
+
+TEST(LogTokenizer, words)
+{
+    IsaSwitch guard;
+    vector<LogTokenizer::Isa> isas = IsaSwitch::supported();
+
+    // words and runs of spaces of all lengths around the vector widths
+    srand(11);
+    const char SPACES[] = " \t\n\v\f\r";
+    for (int test = 0; test < 300; ++test)
+    {
+        string text;
+        while (text.size() < 200)
+        {
+            text.append(rand() % 70, 'a' + rand() % 26);
+            for (int n = rand() % 70; n > 0; --n)
+                text += SPACES[rand() % 6];
+        }
+
+        // a buffer of exactly the text size catches reads past the end
+        vector<char> buf(text.begin(), text.end());
+        const char* end = buf.data() + buf.size();
+
+        for (size_t i = 0; i < isas.size(); ++i)
+        {
+            LogTokenizer::setIsa(isas[i]);
+            for (const char* pos = buf.data(); pos != end; ++pos)
+            {
+                const char* spaces = pos;
+                while (spaces != end && isspace(static_cast<unsigned char>(*spaces)))
+                    ++spaces;
+                const char* word = pos;
+                while (word != end && !isspace(static_cast<unsigned char>(*word)))
+                    ++word;
+
+                ASSERT_EQ(LogTokenizer::skipSpaces(pos, end), spaces) << isas[i];
+                ASSERT_EQ(LogTokenizer::skipWord(pos, end), word) << isas[i];
+            }
+        }
+    }
+}
+
+TEST(LogTokenizer, stamp)
+{
+    IsaSwitch guard;
+    vector<LogTokenizer::Isa> isas = IsaSwitch::supported();
+
+    const string stamp = "2015.06.10 23:59:07";
+    for (size_t i = 0; i < isas.size(); ++i)
+    {
+        LogTokenizer::setIsa(isas[i]);
+
+        int fields[LogTokenizer::STAMP_FIELDS];
+        vector<char> buf(stamp.begin(), stamp.end());
+        ASSERT_TRUE(LogTokenizer::parseStamp(buf.data(), buf.data() + buf.size(), fields));
+        EXPECT_EQ(fields[0], 2015);
+        EXPECT_EQ(fields[1], 6);
+        EXPECT_EQ(fields[2], 10);
+        EXPECT_EQ(fields[3], 23);
+        EXPECT_EQ(fields[4], 59);
+        EXPECT_EQ(fields[5], 7);
+
+        // too short
+        EXPECT_FALSE(LogTokenizer::parseStamp(buf.data(), buf.data() + buf.size() - 1, fields));
+
+        // any single wrong character
+        const char WRONG[] = "x/:. 0";
+        for (size_t pos = 0; pos < stamp.size(); ++pos)
+            for (int w = 0; w < 6; ++w)
+            {
+                string bad = stamp;
+                bad[pos] = WRONG[w];
+                if (bad == stamp || (isdigit(static_cast<unsigned char>(stamp[pos]))
+                                     && isdigit(static_cast<unsigned char>(bad[pos]))))
+                    continue;
+
+                vector<char> badBuf(bad.begin(), bad.end());
+                EXPECT_FALSE(LogTokenizer::parseStamp(badBuf.data(), badBuf.data() + badBuf.size(),
+                                                      fields)) << bad << " " << isas[i];
+            }
+    }
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for MappedFile class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+
+TEST(MappedFile, contents)
+{
+    ifstream fin(DATA_DIR "test1.log", ios::binary);
+    string expected((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+
+    MappedFile file(DATA_DIR "test1.log");
+    ASSERT_EQ(file.size(), expected.size());
+    EXPECT_EQ(string(file.data(), file.size()), expected);
+
+    EXPECT_THROW(MappedFile(DATA_DIR "no_such.log"), logic_error);
+}
+
+TEST(MappedFile, empty)
+{
+    const char* path = "mapped_file_empty.tmp";
+    ofstream(path).close();
+
+    {
+        MappedFile file(path);
+        EXPECT_EQ(file.size(), 0u);
+    }
+
+    remove(path);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+TEST(MappedFile, fifo)
+{
+    // a FIFO has no size: the file must be read to its end, not mapped
+    const char* path = "mapped_file_fifo.tmp";
+    remove(path);
+    ASSERT_EQ(mkfifo(path, 0600), 0);
+
+    const string expected(100 * 1000, 'x');
+    thread writer([&]()
+                  {
+                      ofstream fout(path, ios::binary);
+                      fout << expected;
+                  });
+
+    {
+        MappedFile file(path);
+        EXPECT_EQ(string(file.data(), file.size()), expected);
+    }
+
+    writer.join();
+    remove(path);
+}
+
+#endif
+
+#ifdef __linux__
+
+TEST(MappedFile, procfs)
+{
+    // procfs reports the size of its files as zero
+    MappedFile file("/proc/self/status");
+    EXPECT_NE(string(file.data(), file.size()).find("Name:"), string::npos);
+}
+
+#endif
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for OutputBuffer class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "output_buffer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+TEST(OutputBuffer, chunks)
+{
+    string text;
+    vector<size_t> chunks;
+    OutputBuffer buffer([&](const char* data, size_t size)
+                        {
+                            text.append(data, size);
+                            chunks.push_back(size);
+                        }, 8);
+
+    buffer.write("abc", 3);
+    buffer.put(' ');
+    EXPECT_TRUE(chunks.empty());
+
+    // does not fit: the collected text goes first
+    buffer.write("defgh", 5);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0], 4u);
+
+    // larger than the whole buffer: passed as is
+    buffer.write("0123456789", 10);
+    ASSERT_EQ(chunks.size(), 3u);
+    EXPECT_EQ(chunks[1], 5u);
+    EXPECT_EQ(chunks[2], 10u);
+
+    for (int i = 0; i < 9; ++i)
+        buffer.put('x');
+    buffer.flush();
+    buffer.flush();
+
+    EXPECT_EQ(text, "abc defgh0123456789xxxxxxxxx");
+    ASSERT_EQ(chunks.size(), 5u);
+    EXPECT_EQ(chunks[3], 8u);
+    EXPECT_EQ(chunks[4], 1u);
+}
+
+TEST(OutputBuffer, stream)
+{
+    stringstream out;
+    OutputBuffer buffer(OutputBuffer::streamSink(out));
+
+    buffer.write("2015.07.10 10:33:02", 19);
+    buffer.put('\n');
+    EXPECT_EQ(out.str(), "");
+
+    buffer.flush();
+    EXPECT_EQ(out.str(), "2015.07.10 10:33:02\n");
+}
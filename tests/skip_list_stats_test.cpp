@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for SkipListStats and PerfCounters classes.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "perf_counters.h"
+#include "skip_list.h"
+#include "skip_list_stats.h"
+
+#include <string>
+
+using namespace std;
+
+
+TEST(SkipListStats, countsHops)
+{
+    // no sparse levels: a search walks the dense one
+    SkipList<string, int, 4> list(0.0);
+    for (int i = 0; i < 10; ++i)
+        list.insert("val", i);
+
+    SkipListStats& stats = SkipListStats::local();
+    stats.reset();
+    EXPECT_EQ(list.findLastLessThan(5)->key, 4);
+
+    if (!SkipListStats::isEnabled())
+    {
+        // the macros are no-ops
+        EXPECT_EQ(stats.calls[SkipListStats::OP_FIND_LAST_LESS], 0u);
+        EXPECT_EQ(stats.getTotalHops(), 0u);
+        return;
+    }
+
+    EXPECT_EQ(stats.calls[SkipListStats::OP_FIND_LAST_LESS], 1u);
+    EXPECT_EQ(stats.hops[0], 5u);
+    EXPECT_EQ(stats.getTotalHops(), 5u);
+
+    // the sparse levels take over the walk
+    SkipList<string, int, 4> tall(1.0);
+    for (int i = 0; i < 10; ++i)
+        tall.insert("val", i);
+
+    stats.reset();
+    EXPECT_EQ(tall.findLastLessThan(5)->key, 4);
+    EXPECT_EQ(stats.hops[4], 5u);
+    EXPECT_EQ(stats.hops[0], 0u);
+    EXPECT_EQ(stats.getTotalHops(), 5u);
+
+    EXPECT_STREQ(SkipListStats::getName(SkipListStats::OP_INSERT), "insert");
+}
+
+TEST(PerfCounters, optional)
+{
+    // a VM or a strict perf_event_paranoid may have no counters at all
+    PerfCounters counters;
+    counters.start();
+
+    volatile unsigned sum = 0;
+    for (unsigned i = 0; i < 100000; ++i)
+        sum += i;
+
+    counters.stop();
+
+    if (counters.isAvailable(PerfCounters::EV_INSTRUCTIONS))
+        EXPECT_GT(counters.get(PerfCounters::EV_INSTRUCTIONS), 100000u);
+    else
+        EXPECT_EQ(counters.get(PerfCounters::EV_INSTRUCTIONS), 0u);
+
+    EXPECT_STREQ(PerfCounters::getName(PerfCounters::EV_CACHE_MISSES), "cache_misses");
+}
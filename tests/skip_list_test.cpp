@@ -20,7 +20,11 @@
 
 #include "ordered_list.h"
 #include "skip_list.h"
+#include "time_stamp.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <vector>
 
 using namespace std;
@@ -81,12 +85,14 @@ public:
 
                 if (curr->levelHighest >= i)
                 {
-                    prev->nextJump[i] = curr;
+                    prev->jump[i].next = curr;
                     prev = curr;
                 }
             }
-            prev->nextJump[i] = _preHead;
+            prev->jump[i].next = _preHead;
         }
+
+        restoreIndex();
     }
 
     double getProbability()
@@ -194,13 +200,13 @@ public:
             Node* full = _preHead->next;
             while (full != _preHead)
             {
-                if (sparse->nextJump[i] == full->next)
+                if (sparse->jump[i].next == full->next)
                 {
                     printf("--> ");
-                } else if (sparse->nextJump[i] == full)
+                } else if (sparse->jump[i].next == full)
                 {
                     printf("%3d ", full->key);
-                    sparse = sparse->nextJump[i];
+                    sparse = sparse->jump[i].next;
                 } else
                 {
                     printf("--- ");
@@ -246,6 +252,56 @@ public:
     }
 
 
+    /// \brief Links a new node with the \a key after the last one on the
+    /// dense level and on sparse levels up to \a levelHighest.
+    ///
+    /// The list is bypassed: the tails, the size and the spans are stale
+    /// until restoreIndex().
+    Node* linkLastByHand(int key, const string& value, int levelHighest)
+    {
+        Node* node = new Node(key, value);
+        node->levelHighest = levelHighest;
+
+        Node* last = _preHead;
+        while (last->next != _preHead)
+            last = last->next;
+        last->next = node;
+        node->next = _preHead;
+
+        for (int i = 0; i <= levelHighest; ++i)
+        {
+            last = _preHead;
+            while (last->jump[i].next != _preHead)
+                last = last->jump[i].next;
+            last->jump[i].next = node;
+            node->jump[i].next = _preHead;
+        }
+
+        return node;
+    }
+
+    /// Recounts the index after nodes were linked by hand.
+    void rebuildIndex()
+    {
+        restoreIndex();
+    }
+
+    /// Drops the sparse levels of all the nodes and rebuilds them from the
+    /// dense level.
+    void rebuildSparseLevels()
+    {
+        Node* curr = _preHead;
+        do
+        {
+            for (int i = 0; i <= curr->levelHighest; ++i)
+                curr->jump[i].next = nullptr;
+            curr = curr->next;
+        }
+        while (curr != _preHead);
+
+        restoreIndex();
+    }
+
     /// Checks if all levels have cycled refs (start and end with preHead).
     void checkRefs()
     {
@@ -258,7 +314,7 @@ public:
             // iterate until we reach size or find preHead
             for (int i = 0; i <= size; ++i)
             {
-                Node* next = level == -1 ? curr->next : curr->nextJump[level];
+                Node* next = level == -1 ? curr->next : curr->jump[level].next;
                 if (next == _preHead)
                 {
                     foundPreHead = true;
@@ -507,3 +563,615 @@ TEST(SkipList, removeNext_Repeating1)
 
 
 
+
+TEST(SkipList, arenaAllocator)
+{
+    SkipList<int, int, MAX_LEVELS, ArenaNodeAllocator> list;
+    for (int i = 1000; i > 0; --i)
+        list.insert(i * 10, i);
+
+    SkipList<int, int, MAX_LEVELS, ArenaNodeAllocator>::Node* node = list.getPreHead();
+    for (int i = 1; i <= 1000; ++i)
+    {
+        node = node->next;
+        EXPECT_EQ(node->key, i);
+        EXPECT_EQ(node->value, i * 10);
+    }
+    EXPECT_EQ(node->next, list.getPreHead());
+
+    list.removeNext(list.findLastLessThan(500));
+    EXPECT_EQ(list.findFirst(500), nullptr);
+    EXPECT_NE(list.findFirst(501), nullptr);
+}
+
+TEST(SkipList, slabAllocatorReusesNodes)
+{
+    typedef SkipList<int, int, MAX_LEVELS, SlabNodeAllocator> SlabList;
+    SlabList list(0);           // all the nodes are of the same size
+    for (int i = 0; i < 100; ++i)
+        list.insert(i, i);
+
+    SlabList::Node* removed = list.findFirst(50);
+    list.removeNext(list.findLastLessThan(50));
+    list.insert(-1, 50);
+
+    EXPECT_EQ(list.findFirst(50), removed);
+    EXPECT_EQ(list.findFirst(50)->value, -1);
+}
+
+/// Heap allocator that keeps track of the allocated bytes.
+struct CountingAllocator : public HeapNodeAllocator
+{
+    CountingAllocator() : bytes(0) {}
+
+    void* allocate(size_t size)
+    {
+        bytes += size;
+        return HeapNodeAllocator::allocate(size);
+    }
+
+    void deallocate(void* ptr, size_t size)
+    {
+        bytes -= size;
+        HeapNodeAllocator::deallocate(ptr, size);
+    }
+
+    size_t bytes;
+};
+
+class CountingSkipList
+        : public SkipList<int, int, MAX_LEVELS, CountingAllocator>
+{
+public:
+    explicit CountingSkipList(double prob)
+        : SkipList(prob)
+    {}
+
+    size_t allocatedBytes() const { return _alloc.bytes; }
+};
+
+TEST(SkipList, nodeSizeFollowsHeight)
+{
+    CountingSkipList flat(0);
+    size_t empty = flat.allocatedBytes();
+    for (int i = 0; i < 10; ++i)
+        flat.insert(i, i);
+    EXPECT_EQ(flat.allocatedBytes() - empty, 10 * CountingSkipList::Node::sizeForLevel(-1));
+    EXPECT_LT(CountingSkipList::Node::sizeForLevel(-1), sizeof(CountingSkipList::Node));
+
+    // the spans are cut with the pointers: a node with no sparse levels
+    // keeps nothing of them
+    typedef CountingSkipList::Node Node;
+    Node node;
+    EXPECT_EQ(Node::sizeForLevel(-1),
+              size_t(reinterpret_cast<char*>(node.jump) - reinterpret_cast<char*>(&node)));
+    EXPECT_EQ(Node::sizeForLevel(0) - Node::sizeForLevel(-1), sizeof(Node::jump[0]));
+
+    CountingSkipList full(1);
+    for (int i = 0; i < 10; ++i)
+        full.insert(i, i);
+    EXPECT_EQ(full.allocatedBytes() - empty, 10 * sizeof(CountingSkipList::Node));
+
+    full.removeNext(full.getPreHead());
+    EXPECT_EQ(full.allocatedBytes() - empty, 9 * sizeof(CountingSkipList::Node));
+}
+
+TEST(SkipList, appendSorted)
+{
+    vector<pair<int, string> > items;
+    for (int i = 0; i < 20; ++i)
+        items.push_back(make_pair(i / 2, "v" + to_string(i)));
+
+    TestSkipList list;
+    list.insert("first", 0);
+    list.appendSorted(items.begin(), items.begin() + 10);
+    list.appendSorted(items.begin() + 10, items.end());
+    list.checkRefs();
+
+    EXPECT_EQ(list.size(), 21);
+    EXPECT_EQ(list[0]->value, "first");
+    EXPECT_EQ(list[1]->value, "v0");
+    EXPECT_EQ(list[20]->value, "v19");
+    EXPECT_EQ(list.findLast(), list[20]);
+    EXPECT_EQ(list.findFirst(5), list[11]);
+    EXPECT_EQ(list.findLastLessThan(9), list[18]);
+
+    EXPECT_THROW(list.appendSorted(items.begin(), items.end()), invalid_argument);
+
+    SkipList<string, int, MAX_LEVELS> built(items.begin(), items.end());
+    EXPECT_EQ(built.findFirst(3)->value, "v6");
+    EXPECT_EQ(built.findLast()->value, "v19");
+}
+
+TEST(SkipList, fastPathInsert)
+{
+    TestSkipList list;
+    for (int i = 0; i < 100; ++i)
+        list.insert("v" + to_string(i), i / 3);
+    EXPECT_EQ(list.getFastPathInsertCount(), 100u);
+
+    list.insert("middle", 10);
+    EXPECT_EQ(list.getFastPathInsertCount(), 100u);
+
+    // the tail is removed: the previous node becomes the tail on all levels
+    list.removeNext(list[98]);
+    list.insert("end", 33);
+    EXPECT_EQ(list.getFastPathInsertCount(), 101u);
+    list.checkRefs();
+
+    EXPECT_EQ(list.size(), 101);
+    EXPECT_EQ(list.findLast()->value, "end");
+    EXPECT_EQ(list.findFirst(10)->next->next->next->value, "middle");
+    EXPECT_EQ(list.findLastLessThan(33), list[98]);
+}
+
+TEST(SkipList, fastPathAfterRestoreIndex)
+{
+    TestSkipList list(
+            vector<int>{10, 20, 30},
+            vector<int>{2, 0, 1}
+    );
+
+    list.insert("v40", 40);
+    EXPECT_EQ(list.getFastPathInsertCount(), 1u);
+
+    // nodes linked by hand leave the tails stale: restoreIndex() brings
+    // them back, so the fast path appends after the new last node
+    TestSkipList::Node* high = list.linkLastByHand(50, "v50", MAX_LEVELS - 1);
+    TestSkipList::Node* low = list.linkLastByHand(60, "v60", -1);
+    list.rebuildIndex();
+    EXPECT_EQ(list.findLast(), low);
+    EXPECT_EQ(list.size(), 6);
+
+    list.insert("v70", 70);
+    EXPECT_EQ(list.getFastPathInsertCount(), 2u);
+    EXPECT_EQ(low->next->value, "v70");
+    EXPECT_EQ(list.findLast()->value, "v70");
+    TestSkipList::Node* last = list.findLast();
+    for (int i = 0; i < MAX_LEVELS; ++i)
+    {
+        EXPECT_EQ(high->jump[i].next, i <= last->levelHighest ? last : list.getPreHead()) << i;
+    }
+    list.checkRefs();
+
+    EXPECT_EQ(list.size(), 7);
+    EXPECT_EQ(list.select(6)->key, 70);
+    EXPECT_EQ(list.rank(70), 6u);
+    EXPECT_EQ(list.findLastLessThan(70), low);
+}
+
+TEST(SkipList, restoreIndexTerminatesLevels)
+{
+    // the last links of the levels lead nowhere before the rebuild
+    TestSkipList list(
+            vector<int>{10, 20, 30, 40},
+            vector<int>{3, 1, 2, 0}
+    );
+    list.rebuildSparseLevels();
+    list.checkRefs();
+
+    EXPECT_EQ(list.size(), 4);
+    EXPECT_EQ(list.findFirst(30), list[2]);
+    EXPECT_EQ(list.findLastLessThan(50), list[3]);
+
+    list.insert("end", 50);
+    EXPECT_EQ(list.getFastPathInsertCount(), 1u);
+    EXPECT_EQ(list.select(4)->key, 50);
+    list.checkRefs();
+}
+
+TEST(SkipList, fingerSearch)
+{
+    TestSkipList list(
+            vector<int>{10, 20, 20, 30, 40, 50, 60, 70, 80},
+            vector<int>{1, 0, 3, 0, 2, 0, 1, 0, 4}
+    );
+
+    for (int hint = -1; hint < 9; ++hint)
+        for (int key = 5; key <= 90; key += 5)
+        {
+            EXPECT_EQ(list.findLastLessThan(key, list[hint]), list.findLastLessThan(key))
+                    << "hint " << hint << ", key " << key;
+            EXPECT_EQ(list.findFirst(key, list[hint]), list.findFirst(key))
+                    << "hint " << hint << ", key " << key;
+        }
+
+    EXPECT_EQ(list.findLastLessThan(30, nullptr), list[2]);
+}
+
+TEST(SkipList, fingerSearchRandom)
+{
+    TestSkipList list;
+    for (int i = 0; i < 2000; ++i)
+        list.insert("val", (i * 7919) % 1000);
+
+    TestSkipList::Node* hint = list.getPreHead();
+    for (int key = 0; key <= 1000; key += 3)
+    {
+        TestSkipList::Node* found = list.findLastLessThan(key, hint);
+        EXPECT_EQ(found, list.findLastLessThan(key));
+        hint = found;
+    }
+}
+
+TEST(SkipList, iterators)
+{
+    TestSkipList list(
+            vector<int>{10, 20, 20, 20, 30, 40},
+            vector<int>{1, 0, 3, 0, 2, 0},
+            vector<string>{"a", "b", "c", "d", "e", "f"}
+    );
+
+    string joined;
+    for (TestSkipList::iterator it = list.begin(); it != list.end(); ++it)
+        joined += it->value;
+    EXPECT_EQ(joined, "abcdef");
+
+    const TestSkipList& clist = list;
+    EXPECT_EQ(std::distance(clist.begin(), clist.end()), 6);
+
+    EXPECT_EQ(list.lower_bound(20)->value, "b");
+    EXPECT_EQ(list.upper_bound(20)->value, "e");
+    EXPECT_EQ(list.lower_bound(25)->value, "e");
+    EXPECT_EQ(list.upper_bound(5)->value, "a");
+    EXPECT_EQ(list.lower_bound(50), list.end());
+    EXPECT_EQ(list.upper_bound(40), list.end());
+
+    pair<TestSkipList::const_iterator, TestSkipList::const_iterator> range = clist.equal_range(20);
+    EXPECT_EQ(std::distance(range.first, range.second), 3);
+    EXPECT_EQ(range.first->value, "b");
+
+    range = clist.equal_range(15);
+    EXPECT_EQ(range.first, range.second);
+
+    TestSkipList::const_iterator converted = list.begin();
+    EXPECT_EQ(converted, clist.begin());
+    long count = std::count_if(list.begin(), list.end(),
+                               [](const TestSkipList::Node& node) { return node.key == 20; });
+    EXPECT_EQ(count, 3);
+}
+
+TEST(SkipList, staticSkipList)
+{
+    // the same operations on both lists must give the same results
+    SkipList<int, int, MAX_LEVELS> dynamicList;
+    StaticSkipList<int, int, MAX_LEVELS> staticList;
+
+    srand(7);
+    for (int i = 0; i < 2000; ++i)
+    {
+        int key = rand() % 300;
+        dynamicList.insert(i, key);
+        staticList.insert(i, key);
+    }
+
+    for (int i = 0; i < 500; ++i)
+    {
+        int key = rand() % 300;
+        if (staticList.findFirst(key) == nullptr)
+            continue;
+
+        dynamicList.removeNext(dynamicList.findLastLessThan(key));
+        staticList.removeNext(staticList.findLastLessThan(key));
+    }
+
+    EXPECT_TRUE(std::equal(staticList.begin(), staticList.end(), dynamicList.begin(),
+                           [](const NodeSkipList<int, int, MAX_LEVELS>& a,
+                              const NodeSkipList<int, int, MAX_LEVELS>& b)
+                           { return a.key == b.key && a.value == b.value; }));
+    EXPECT_EQ(std::distance(staticList.begin(), staticList.end()),
+              std::distance(dynamicList.begin(), dynamicList.end()));
+
+    for (int key = -1; key <= 300; ++key)
+    {
+        NodeSkipList<int, int, MAX_LEVELS>* found = staticList.findFirst(key);
+        NodeSkipList<int, int, MAX_LEVELS>* expected = dynamicList.findFirst(key);
+        ASSERT_EQ(found == nullptr, expected == nullptr);
+        if (found)
+        {
+            EXPECT_EQ(found->value, expected->value);
+        }
+
+        EXPECT_EQ(staticList.upper_bound(key) == staticList.end(),
+                  dynamicList.upper_bound(key) == dynamicList.end());
+    }
+}
+
+TEST(SkipList, rankAndSelect)
+{
+    SkipList<int, int, MAX_LEVELS> list;
+    vector<int> keys;
+
+    srand(11);
+    for (int i = 0; i < 3000; ++i)
+    {
+        int key = rand() % 500;
+        if (i % 3 == 2 && !keys.empty())
+        {
+            // removes a random one of the equal keys
+            int pos = rand() % keys.size();
+            int first = lower_bound(keys.begin(), keys.end(), keys[pos]) - keys.begin();
+            NodeSkipList<int, int, MAX_LEVELS>* before = list.findLastLessThan(keys[pos]);
+            for (int j = first; j < pos; ++j)
+                before = before->next;
+
+            list.removeNext(before);
+            keys.erase(keys.begin() + pos);
+        }
+        else
+        {
+            list.insert(i, key);
+            keys.insert(upper_bound(keys.begin(), keys.end(), key), key);
+        }
+    }
+
+    ASSERT_EQ(list.size(), keys.size());
+    for (int key = -1; key <= 500; ++key)
+        EXPECT_EQ(list.rank(key),
+                  size_t(lower_bound(keys.begin(), keys.end(), key) - keys.begin()));
+
+    size_t k = 0;
+    for (SkipList<int, int, MAX_LEVELS>::iterator it = list.begin(); it != list.end(); ++it, ++k)
+        ASSERT_EQ(list.select(k), it.getNode());
+
+    EXPECT_EQ(list.select(keys.size()), nullptr);
+}
+
+TEST(SkipList, rankAndSelectAfterExternalLinks)
+{
+    TestSkipList list(
+            vector<int>{10, 20, 20, 30, 40},
+            vector<int>{2, 0, 3, 1, 0},
+            vector<string>{"a", "b", "c", "d", "e"}
+    );
+
+    EXPECT_EQ(list.SkipList::size(), 5u);
+    EXPECT_EQ(list.rank(20), 1u);
+    EXPECT_EQ(list.rank(25), 3u);
+    EXPECT_EQ(list.select(2)->value, "c");
+
+    list.removeNext(list[0]);
+    list.insert("f", 15);
+    list.insert("g", 50);
+    EXPECT_EQ(list.SkipList::size(), 6u);
+    EXPECT_EQ(list.rank(30), 3u);
+    EXPECT_EQ(list.select(1)->value, "f");
+    EXPECT_EQ(list.select(3)->value, "d");
+    EXPECT_EQ(list.select(5)->value, "g");
+    EXPECT_EQ(list.select(6), nullptr);
+}
+
+TEST(SkipList, appendAfterExternalLinks)
+{
+    // tall nodes linked by hand: the tails of all the levels are stale
+    TestSkipList list(
+            vector<int>{10, 20, 30, 40},
+            vector<int>{MAX_LEVELS, 3, MAX_LEVELS, 1}
+    );
+
+    // low nodes at the end: levels above them are not touched by the links
+    for (int i = 0; i < 20; ++i)
+        list.insert("new" + to_string(i), 50 + i);
+    list.checkRefs();
+
+    ASSERT_EQ(list.SkipList::size(), 24u);
+    for (size_t k = 0; k < 24; ++k)
+    {
+        ASSERT_NE(list.select(k), nullptr) << k;
+        EXPECT_EQ(list.select(k)->key, k < 4 ? int(k + 1) * 10 : int(k) + 46) << k;
+        EXPECT_EQ(list.rank(list.select(k)->key), k);
+    }
+    EXPECT_EQ(list.select(24), nullptr);
+    EXPECT_EQ(list.findLast()->key, 69);
+}
+
+TEST(SkipList, seededLevels)
+{
+    // the same seed gives the same heights, whatever the global rand() does
+    TestSkipList list1(0.5), list2(0.5);
+    SkipList<string, int, MAX_LEVELS> seeded1(0.5, 42), seeded2(0.5, 42);
+    for (int i = 0; i < 1000; ++i)
+    {
+        srand(i);
+        list1.insert("a", i);
+        seeded1.insert("a", i);
+        srand(i + 1);
+        list2.insert("a", i);
+        seeded2.insert("a", i);
+    }
+
+    bool sameHeights = true;
+    for (int i = 0; i < 1000; ++i)
+        sameHeights = sameHeights && list1[i]->levelHighest == list2[i]->levelHighest
+                                  && seeded1.select(i)->levelHighest == seeded2.select(i)->levelHighest;
+    EXPECT_TRUE(sameHeights);
+
+    bool otherSeedDiffers = false;
+    for (int i = 0; i < 1000; ++i)
+        otherSeedDiffers = otherSeedDiffers
+                || seeded1.select(i)->levelHighest != list1[i]->levelHighest;
+    EXPECT_TRUE(otherSeedDiffers);
+}
+
+TEST(SkipList, seededRange)
+{
+    // integral arguments take the seeded constructor, not the range one
+    SkipList<int, int, 5> seeded(1, 42);
+    EXPECT_EQ(seeded.size(), 0u);
+
+    vector<pair<int, int> > items;
+    for (int i = 0; i < 1000; ++i)
+        items.push_back(make_pair(i, i));
+
+    SkipList<int, int, MAX_LEVELS> inserted(0.5, 42);
+    for (int i = 0; i < 1000; ++i)
+        inserted.insert(i, i);
+    StaticSkipList<int, int, MAX_LEVELS> built(items.begin(), items.end(), 0.5, 42);
+    ASSERT_EQ(built.size(), 1000u);
+
+    bool sameHeights = true;
+    for (int i = 0; i < 1000; ++i)
+        sameHeights = sameHeights && built.select(i)->levelHighest == inserted.select(i)->levelHighest;
+    EXPECT_TRUE(sameHeights);
+}
+
+TEST(SkipList, levelDistribution)
+{
+    const int COUNT = 100 * 1000;
+    const double probabilities[] = {0.5, 0.25, 0.7};
+
+    for (int j = 0; j < 3; ++j)
+    {
+        double p = probabilities[j];
+        TestSkipList list(p);
+        for (int i = 0; i < COUNT; ++i)
+            list.insert("", i);
+
+        // the mean height is p / (1 - p) for an unlimited number of levels
+        double expected = p / (1 - p) - pow(p, MAX_LEVELS + 1) / (1 - p);
+        EXPECT_NEAR(list.meanHeight(), expected, 0.05) << "p = " << p;
+    }
+}
+
+TEST(SkipList, keyPrefixOrder)
+{
+    vector<int> ints{INT32_MIN, -300, -1, 0, 1, 255, 256, INT32_MAX};
+    for (size_t i = 1; i < ints.size(); ++i)
+        EXPECT_LT(KeyPrefix<int>::get(ints[i - 1]), KeyPrefix<int>::get(ints[i]));
+
+    vector<string> strings{"", "a", "a\x01", "ab", "abcdefgh", "abcdefghz", "b", "\xff"};
+    for (size_t i = 1; i < strings.size(); ++i)
+        EXPECT_LE(KeyPrefix<string>::get(strings[i - 1]), KeyPrefix<string>::get(strings[i]));
+    EXPECT_EQ(KeyPrefix<string>::get("abcdefgh"), KeyPrefix<string>::get("abcdefghz"));
+
+    EXPECT_LT(KeyPrefix<TimeStamp>::get(TimeStamp(1960)), KeyPrefix<TimeStamp>::get(TimeStamp(1970)));
+    EXPECT_LT(KeyPrefix<TimeStamp>::get(TimeStamp(2015, 6, 10, 0, 0, 0)),
+              KeyPrefix<TimeStamp>::get(TimeStamp(2015, 6, 10, 0, 0, 0, 1)));
+}
+
+/// Checks that the tower keys of the \a list are the prefixes of the keys
+/// the links lead to.
+template <class List>
+static void checkTowerKeys(List& list)
+{
+    typedef typename List::Node Node;
+    typedef KeyPrefix<typename std::remove_const<decltype(Node::key)>::type> Prefix;
+
+    Node* preHead = list.getPreHead();
+    for (Node* run = preHead->next; run != preHead; run = run->next)
+        for (int i = 0; i <= run->levelHighest; ++i)
+            if (run->jump[i].next != preHead)
+            {
+                ASSERT_EQ(run->jump[i].key, Prefix::get(run->jump[i].next->key));
+            }
+}
+
+/// Runs the same inserts, removals and searches on a plain list and on a
+/// list with inline keys; \a makeKey maps numbers to keys in order.
+template <class Key, class MakeKey>
+static void compareInlineKeys(MakeKey makeKey)
+{
+    // the same seed gives the same towers
+    SkipList<int, Key, MAX_LEVELS> plain(0.5, 17);
+    SkipList<int, Key, MAX_LEVELS, HeapNodeAllocator, InlineKeyTower> inlined(0.5, 17);
+
+    srand(23);
+    for (int i = 0; i < 3000; ++i)
+    {
+        Key key = makeKey(rand() % 400);
+        if (i % 4 == 3 && plain.findFirst(key) != nullptr)
+        {
+            plain.removeNext(plain.findLastLessThan(key));
+            inlined.removeNext(inlined.findLastLessThan(key));
+        }
+        else
+        {
+            plain.insert(i, key);
+            inlined.insert(i, key);
+        }
+    }
+
+    checkTowerKeys(inlined);
+    ASSERT_EQ(plain.size(), inlined.size());
+
+    // values are the numbers of the inserts, -1 stands for the sentinel
+    auto plainValue = [&plain](NodeSkipList<int, Key, MAX_LEVELS>* node)
+                      { return node == plain.getPreHead() ? -1 : node->value; };
+    auto inlinedValue = [&inlined](NodeSkipList<int, Key, MAX_LEVELS, InlineKeyTower>* node)
+                        { return node == inlined.getPreHead() ? -1 : node->value; };
+
+    auto hint = inlined.getPreHead()->next;
+    for (int k = -1; k <= 401; ++k)
+    {
+        Key key = makeKey(k);
+        EXPECT_EQ(plainValue(plain.findLastLessThan(key)),
+                  inlinedValue(inlined.findLastLessThan(key)));
+        EXPECT_EQ(plainValue(plain.findLastNotGreaterThan(key)),
+                  inlinedValue(inlined.findLastNotGreaterThan(key)));
+        EXPECT_EQ(plain.rank(key), inlined.rank(key));
+        EXPECT_EQ(inlined.findLastLessThan(key, hint), inlined.findLastLessThan(key));
+
+        auto found = inlined.findFirst(key);
+        ASSERT_EQ(found == nullptr, plain.findFirst(key) == nullptr) << k;
+        if (found)
+        {
+            EXPECT_EQ(found->value, plain.findFirst(key)->value);
+        }
+    }
+}
+
+TEST(SkipList, inlineKeys)
+{
+    compareInlineKeys<int>([](int k) { return k * 3 - 600; });
+
+    // long common beginnings: prefixes are equal, the keys decide
+    compareInlineKeys<string>([](int k)
+                              {
+                                  string key = to_string(k + 1000);
+                                  return "user" + key.substr(0, 2) + "/" + key;
+                              });
+
+    compareInlineKeys<TimeStamp>([](int k) { return TimeStamp(2015, 6, 10, 0, 0, k / 7, k); });
+
+    // the prefixes are cut with the tower: only sparse levels pay for them
+    typedef NodeSkipList<int, int, MAX_LEVELS> PlainNode;
+    typedef NodeSkipList<int, int, MAX_LEVELS, InlineKeyTower> InlineNode;
+    EXPECT_EQ(InlineNode::sizeForLevel(-1), PlainNode::sizeForLevel(-1));
+    EXPECT_EQ(InlineNode::sizeForLevel(3) - InlineNode::sizeForLevel(2),
+              PlainNode::sizeForLevel(3) - PlainNode::sizeForLevel(2) + sizeof(uint64_t));
+}
+
+TEST(SkipList, inlineKeysAfterExternalLinks)
+{
+    class InlineList : public SkipList<string, int, MAX_LEVELS, HeapNodeAllocator, InlineKeyTower>
+    {
+    public:
+        void linkAll(int count)
+        {
+            // every node gets all the levels, the tower keys are left unset
+            Node* last = _preHead;
+            for (int i = 0; i < count; ++i)
+            {
+                Node* node = new Node(i * 10, "v" + to_string(i), MAX_LEVELS - 1);
+                last->next = node;
+                for (int j = 0; j < MAX_LEVELS; ++j)
+                    last->jump[j].next = node;
+                last = node;
+            }
+
+            last->next = _preHead;
+            for (int j = 0; j < MAX_LEVELS; ++j)
+                last->jump[j].next = _preHead;
+
+            restoreIndex();
+        }
+    };
+
+    InlineList list;
+    list.linkAll(20);
+    checkTowerKeys(list);
+
+    EXPECT_EQ(list.findFirst(70)->value, "v7");
+    EXPECT_EQ(list.findLastLessThan(75)->value, "v7");
+    EXPECT_EQ(list.rank(75), 8u);
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for StringInterner class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "string_interner.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+TEST(StringInterner, simple)
+{
+    StringInterner dict;
+    EXPECT_EQ(dict.find("e-maxx.ru"), StringInterner::NOT_FOUND);
+
+    StringInterner::Id maxx = dict.intern("e-maxx.ru");
+    StringInterner::Id msdn = dict.intern("msdn.com");
+    EXPECT_EQ(maxx, 0u);
+    EXPECT_EQ(msdn, 1u);
+
+    // a part of a line is found with no copying
+    const char* line = "2015.06.10 10:33:02 user126 e-maxx.ru";
+    EXPECT_EQ(dict.find(line + 28, 9), maxx);
+    EXPECT_EQ(dict.intern(line + 28, 9), maxx);
+    EXPECT_EQ(dict.find(line + 28, 8), StringInterner::NOT_FOUND);
+
+    EXPECT_EQ(dict.intern(""), 2u);
+    EXPECT_EQ(dict.find(""), 2u);
+    EXPECT_EQ(dict.get(msdn), "msdn.com");
+    EXPECT_EQ(dict.size(), 3u);
+}
+
+TEST(StringInterner, manyStrings)
+{
+    const int COUNT = 10000;
+
+    StringInterner dict;
+    const string& first = dict.get(dict.intern("user0"));
+    for (int i = 0; i < COUNT; ++i)
+        EXPECT_EQ(dict.intern("user" + to_string(i)), StringInterner::Id(i));
+
+    EXPECT_EQ(dict.size(), size_t(COUNT));
+    for (int i = COUNT - 1; i >= 0; --i)
+    {
+        string name = "user" + to_string(i);
+        ASSERT_EQ(dict.find(name), StringInterner::Id(i));
+        ASSERT_EQ(dict.get(i), name);
+    }
+
+    // references survive the growth
+    EXPECT_EQ(first, "user0");
+}
@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Unit tests for TimeStamp class.
+///
+/// Gtest-based unit test.
+/// The naming conventions imply the name of a unit-test module is the same as
+/// the name of the corresponding tested module with _test suffix
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "time_stamp.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+static string toString(const TimeStamp& ts)
+{
+    stringstream out;
+    out << ts;
+    return out.str();
+}
+
+
+TEST(TimeStamp, format)
+{
+    EXPECT_EQ(toString(TimeStamp(2015, 6, 10, 10, 33, 1)), "2015.06.10 10:33:01");
+    EXPECT_EQ(toString(TimeStamp(1970)), "1970.01.01 00:00:00");
+    EXPECT_EQ(toString(TimeStamp(1969, 12, 31, 23, 59, 59)), "1969.12.31 23:59:59");
+    EXPECT_EQ(toString(TimeStamp(2000, 2, 29, 12)), "2000.02.29 12:00:00");
+    EXPECT_EQ(toString(TimeStamp(1900, 3, 1)), "1900.03.01 00:00:00");
+    EXPECT_EQ(toString(TimeStamp(2100, 12, 31, 23, 59, 59)), "2100.12.31 23:59:59");
+
+    EXPECT_EQ(TimeStamp(1970, 1, 2).getSeconds(), 86400);
+    EXPECT_EQ(TimeStamp(2015, 6, 10, 10, 33, 1).getSeconds(), 1433932381);
+}
+
+TEST(TimeStamp, normalization)
+{
+    EXPECT_EQ(TimeStamp(2015, 6, 10, 10, 33, 60), TimeStamp(2015, 6, 10, 10, 34, 0));
+    EXPECT_EQ(TimeStamp(2015, 13, 1), TimeStamp(2016, 1, 1));
+    EXPECT_EQ(TimeStamp(2015, 0, 1), TimeStamp(2014, 12, 1));
+    EXPECT_EQ(TimeStamp(2015, 2, 29), TimeStamp(2015, 3, 1));
+    EXPECT_EQ(TimeStamp(2016, 3, 0), TimeStamp(2016, 2, 29));
+    EXPECT_EQ(TimeStamp(2015, 6, 10, 24), TimeStamp(2015, 6, 11));
+}
+
+TEST(TimeStamp, compare)
+{
+    TimeStamp a(2015, 6, 10, 10, 33, 1);
+    TimeStamp b(2015, 6, 10, 10, 33, 2);
+    TimeStamp c(2014, 12, 31, 23, 59, 59);
+
+    EXPECT_TRUE(a < b);
+    EXPECT_TRUE(c < a);
+    EXPECT_TRUE(a <= a);
+    EXPECT_TRUE(b > a);
+    EXPECT_TRUE(b >= b);
+    EXPECT_TRUE(a != b);
+    EXPECT_FALSE(b < a);
+    EXPECT_FALSE(a > a);
+}
+
+TEST(TimeStamp, read)
+{
+    stringstream in("2015.06.17 10:33:03 rest\n2015.06.17 bad");
+
+    TimeStamp ts(2000);
+    in >> ts;
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 17, 10, 33, 3));
+
+    string rest;
+    in >> rest;
+    EXPECT_EQ(rest, "rest");
+
+    // a broken stamp is not read
+    in >> ts;
+    EXPECT_FALSE(in);
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 17, 10, 33, 3));
+}
+
+TEST(TimeStamp, readAtEnd)
+{
+    // nothing follows the seconds: there is no fraction to look for
+    istringstream whole("2015.06.10 10:33:01");
+    TimeStamp ts(2000);
+    EXPECT_TRUE(bool(whole >> ts));
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 10, 10, 33, 1));
+    EXPECT_TRUE(whole.eof());
+
+    istringstream fraction("2015.06.10 10:33:01.25");
+    EXPECT_TRUE(bool(fraction >> ts));
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 10, 10, 33, 1, 250000));
+
+    // a dot with no digits is still an error
+    istringstream dot("2015.06.10 10:33:02.");
+    EXPECT_FALSE(bool(dot >> ts));
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 10, 10, 33, 1, 250000));
+}
+
+TEST(TimeStamp, parse)
+{
+    const string str = "2015.06.17 10:33:03 user";
+    TimeStamp ts(2000);
+    EXPECT_EQ(ts.parse(str.data(), str.data() + str.size()), str.data() + 19);
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 17, 10, 33, 3));
+
+    const char* broken[] = {"2015.06.17 10:33:0", "2015.6.17 10:33:03", "2015-06-17 10:33:03",
+                            "2015.06.17 10:33:x3", " 2015.06.17 10:33:03"};
+    for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i)
+    {
+        const char* end = broken[i] + strlen(broken[i]);
+        EXPECT_EQ(ts.parse(broken[i], end), nullptr) << broken[i];
+    }
+
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 17, 10, 33, 3));
+}
+
+/// Checks that TimeStamp::parse() reads the stamps of test2.log the same way
+/// operator>> does.
+TEST(TimeStamp, parseMatchesStream)
+{
+    ifstream fin(DATA_DIR "test2.log");
+    ASSERT_TRUE(fin.good());
+
+    string line;
+    int count = 0;
+    while (getline(fin, line))
+    {
+        istringstream in(line);
+        TimeStamp streamed(2000), parsed(2000);
+        ASSERT_TRUE(bool(in >> streamed)) << line;
+        ASSERT_NE(parsed.parse(line.data(), line.data() + line.size()), nullptr) << line;
+        EXPECT_EQ(parsed, streamed) << line;
+        ++count;
+    }
+
+    EXPECT_GT(count, 0);
+}
+
+TEST(TimeStamp, formatter)
+{
+    // each next stamp differs from the previous one in another part
+    const TimeStamp stamps[] = {
+        TimeStamp(2015, 6, 10, 10, 33, 1), TimeStamp(2015, 6, 10, 10, 33, 1),
+        TimeStamp(2015, 6, 10, 10, 33, 7), TimeStamp(2015, 6, 10, 10, 34, 7),
+        TimeStamp(2015, 6, 10, 23, 59, 59), TimeStamp(2015, 6, 11),
+        TimeStamp(2016, 2, 29, 0, 0, 1), TimeStamp(2016, 2, 28, 0, 0, 1),
+        TimeStamp(1969, 12, 31, 23, 59, 59), TimeStamp(1969, 12, 31, 23, 59, 58),
+        TimeStamp(2015, 6, 10, 10, 33, 1)
+    };
+
+    TimeStampFormatter formatter;
+    for (size_t i = 0; i < sizeof(stamps) / sizeof(stamps[0]); ++i)
+    {
+        char buf[TimeStamp::SIZE_MAXSTRTIME];
+        char* end = formatter.format(stamps[i], buf);
+        EXPECT_EQ(string(buf, end), toString(stamps[i]));
+
+        struct tm time = stamps[i].toTm();
+        char expected[TimeStamp::SIZE_MAXSTRTIME];
+        strftime(expected, sizeof(expected), "%Y.%m.%d %H:%M:%S", &time);
+        EXPECT_EQ(string(buf, end), expected);
+    }
+}
+
+TEST(TimeStamp, fraction)
+{
+    TimeStamp whole(2015, 6, 10, 10, 33, 1);
+    TimeStamp ms(2015, 6, 10, 10, 33, 1, 123000);
+    TimeStamp us(2015, 6, 10, 10, 33, 1, 123456);
+
+    EXPECT_TRUE(whole < ms);
+    EXPECT_TRUE(ms < us);
+    EXPECT_TRUE(us < TimeStamp(2015, 6, 10, 10, 33, 2));
+    EXPECT_EQ(us.getSeconds(), whole.getSeconds());
+    EXPECT_EQ(us.getMicroseconds() - whole.getMicroseconds(), 123456);
+    EXPECT_EQ(TimeStamp(1969, 12, 31, 23, 59, 59, 500000).getSeconds(), -1);
+
+    EXPECT_EQ(toString(whole), "2015.06.10 10:33:01");
+    EXPECT_EQ(toString(ms), "2015.06.10 10:33:01.123");
+    EXPECT_EQ(toString(us), "2015.06.10 10:33:01.123456");
+    EXPECT_EQ(toString(TimeStamp(2015, 6, 10, 10, 33, 1, 5)), "2015.06.10 10:33:01.000005");
+    EXPECT_EQ(toString(TimeStamp(1969, 12, 31, 23, 59, 59, 500000)), "1969.12.31 23:59:59.500");
+
+    // fixed format parser
+    const char* strs[] = {"2015.06.10 10:33:01.123456", "2015.06.10 10:33:01.123",
+                          "2015.06.10 10:33:01.123456789", "2015.06.10 10:33:01.12"};
+    const int micros[] = {123456, 123000, 123456, 120000};
+    for (int i = 0; i < 4; ++i)
+    {
+        TimeStamp ts;
+        const char* end = strs[i] + strlen(strs[i]);
+        EXPECT_EQ(ts.parse(strs[i], end), end) << strs[i];
+        EXPECT_EQ(ts, TimeStamp(2015, 6, 10, 10, 33, 1, micros[i])) << strs[i];
+    }
+
+    const char* broken[] = {"2015.06.10 10:33:01.", "2015.06.10 10:33:01.1234567890"};
+    for (int i = 0; i < 2; ++i)
+    {
+        TimeStamp ts;
+        EXPECT_EQ(ts.parse(broken[i], broken[i] + strlen(broken[i])), nullptr) << broken[i];
+    }
+
+    // stream operators
+    stringstream in("2015.06.10 10:33:01.123456 a 2015.06.10 10:33:01.5 b 2015.06.10 10:33:01. c");
+    TimeStamp ts;
+    string word;
+    in >> ts >> word;
+    EXPECT_EQ(ts, us);
+    EXPECT_EQ(word, "a");
+    in >> ts >> word;
+    EXPECT_EQ(ts, TimeStamp(2015, 6, 10, 10, 33, 1, 500000));
+    EXPECT_EQ(word, "b");
+    in >> ts;
+    EXPECT_FALSE(in);
+
+    // formatter with changing fractions
+    TimeStampFormatter formatter;
+    const TimeStamp stamps[] = {us, ms, whole, us, TimeStamp(2015, 6, 10, 10, 33, 2, 1000)};
+    for (int i = 0; i < 5; ++i)
+    {
+        char buf[TimeStamp::SIZE_MAXSTRTIME];
+        EXPECT_EQ(string(buf, formatter.format(stamps[i], buf)), toString(stamps[i]));
+    }
+}
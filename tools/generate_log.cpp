@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief      Generates synthetic access logs.
+///
+/// Usage: generate_log [options] > file.log
+///     --lines N       number of records (1000000)
+///     --users N       number of different users (5000)
+///     --hosts N       number of different hosts (300)
+///     --zipf S        exponent of the host popularity, 0 is uniform (1.0)
+///     --rate R        records per second (20)
+///     --disorder F    fraction of delayed records (0)
+///     --max-delay N   largest delay in seconds (5)
+///     --user-width N  right-align users to N characters (0)
+///     --seed N        seed of the random generator (5489)
+///     --out FILE      output file instead of the standard output
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "log_generator.h"
+
+
+/// Prints the usage and returns the exit code of a bad call.
+static int usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--lines N] [--users N] [--hosts N] [--zipf S]"
+                 " [--rate R] [--disorder F] [--max-delay N] [--user-width N] [--seed N]"
+                 " [--out FILE]" << std::endl;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    LogGenerator::Options options;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 == argc)
+            return usage(argv[0]);
+
+        const char* name = argv[i];
+        const char* value = argv[++i];
+
+        if (std::strcmp(name, "--lines") == 0)
+            options.lines = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(name, "--users") == 0)
+            options.users = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(name, "--hosts") == 0)
+            options.hosts = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(name, "--zipf") == 0)
+            options.zipf = std::atof(value);
+        else if (std::strcmp(name, "--rate") == 0)
+            options.rate = std::atof(value);
+        else if (std::strcmp(name, "--disorder") == 0)
+            options.disorder = std::atof(value);
+        else if (std::strcmp(name, "--max-delay") == 0)
+            options.maxDelay = std::atoi(value);
+        else if (std::strcmp(name, "--user-width") == 0)
+            options.userWidth = std::atoi(value);
+        else if (std::strcmp(name, "--seed") == 0)
+            options.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(name, "--out") == 0)
+            outPath = value;
+        else
+            return usage(argv[0]);
+    }
+
+    try
+    {
+        LogGenerator generator(options);
+
+        std::ofstream file;
+        if (!outPath.empty())
+        {
+            file.open(outPath, std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "Couldn't open file " << outPath << std::endl;
+                return 1;
+            }
+        }
+
+        std::ostream& out = outPath.empty() ? std::cout : file;
+        generator.generate(OutputBuffer::streamSink(out));
+        out.flush();
+
+        if (!out)
+        {
+            std::cerr << "Couldn't write the log" << std::endl;
+            return 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}